@@ -244,6 +244,2837 @@
     "plt.show()"
    ]
   },
+  {
+   "cell_type": "markdown",
+   "id": "ef41ef80-ed6f-41c1-8bf4-21caf1bd6144",
+   "metadata": {},
+   "source": [
+    "### Step 3. Batch fitting of many assays in one call\n",
+    "A plate reader produces thousands of $[S]$, $v$ series per run, and calling `np.linalg.lstsq` once per series spends most of its time in Python overhead rather than arithmetic. The derivation in Step 2 shows that the fit needs only the summary statistics $n$, $S_x$, $S_y$, $S_{xx}$ and $S_{xy}$, so every series can be reduced in a single vectorized pass.\n",
+    "\n",
+    "All series are stored back to back in two contiguous arrays (struct-of-arrays), `S` and `v`, together with an `offsets` array of length $N+1$ so that series $j$ occupies `S[offsets[j]:offsets[j+1]]`. `np.add.reduceat` sums each segment with a SIMD inner loop, and the closed-form solution is then evaluated for all $N$ series at once:\n",
+    "<p align='center'>\n",
+    "    $$m=\\frac{nS_{xy}-S_x S_y}{nS_{xx}-S_x^2},\\quad b=\\frac{S_yS_{xx}-S_{xy}S_x}{nS_{xx}-S_x^2}$$\n",
+    "</p>\n",
+    "The residual sum of squares follows from the same sums without revisiting the data, $RSS = S_{yy} - bS_y - mS_{xy}$."
+   ]
+  },
+  {
+   "cell_type": "code",
+   "execution_count": 84,
+   "id": "6d0ee628-8995-4cba-bb6c-3c4b2ac73537",
+   "metadata": {},
+   "outputs": [
+    {
+     "name": "stdout",
+     "output_type": "stream",
+     "text": [
+      "vmax = 0.0145 mM/s\n",
+      "Km   = 0.3267 mM\n",
+      "k2   = 0.5166 s^-1\n"
+     ]
+    }
+   ],
+   "source": [
+    "import numpy as np\n",
+    "\n",
+    "def lineweaver_burk_transform(S, v):\n",
+    "    \"\"\"Lineweaver-Burk coordinates x = 1/[S], y = 1/v.\"\"\"\n",
+    "    return 1 / S, 1 / v\n",
+    "\n",
+    "def lineweaver_burk_reduce(x, y, offsets):\n",
+    "    \"\"\"Per-series n, S_x, S_y, S_xx, S_xy and S_yy of transformed points.\"\"\"\n",
+    "    starts = offsets[:-1]\n",
+    "    n = np.diff(offsets).astype(float)\n",
+    "    Sx = np.add.reduceat(x, starts)\n",
+    "    Sy = np.add.reduceat(y, starts)\n",
+    "    Sxx = np.add.reduceat(x * x, starts)\n",
+    "    Sxy = np.add.reduceat(x * y, starts)\n",
+    "    Syy = np.add.reduceat(y * y, starts)\n",
+    "    return n, Sx, Sy, Sxx, Sxy, Syy\n",
+    "\n",
+    "def lineweaver_burk_sums(S, v, offsets):\n",
+    "    \"\"\"Per-series n, S_x, S_y, S_xx, S_xy and S_yy for x = 1/[S], y = 1/v.\"\"\"\n",
+    "    return lineweaver_burk_reduce(*lineweaver_burk_transform(S, v), offsets)\n",
+    "\n",
+    "def lineweaver_burk_line(n, Sx, Sy, Sxx, Sxy, Syy):\n",
+    "    \"\"\"Closed-form slope, intercept and residual sum of squares.\"\"\"\n",
+    "    delta = n * Sxx - Sx**2\n",
+    "    m = (n * Sxy - Sx * Sy) / delta\n",
+    "    b = (Sy * Sxx - Sxy * Sx) / delta\n",
+    "    rss = Syy - b * Sy - m * Sxy\n",
+    "    return m, b, rss\n",
+    "\n",
+    "def lineweaver_burk_derive(m, b, E0=0.028):\n",
+    "    \"\"\"vmax, Km and k2 from the slope and intercept.\"\"\"\n",
+    "    vmax = 1 / b\n",
+    "    return vmax, m * vmax, vmax / E0\n",
+    "\n",
+    "def lineweaver_burk_solve(n, Sx, Sy, Sxx, Sxy, Syy, E0=0.028):\n",
+    "    \"\"\"Closed-form slope/intercept and the derived vmax, Km and k2.\"\"\"\n",
+    "    m, b, rss = lineweaver_burk_line(n, Sx, Sy, Sxx, Sxy, Syy)\n",
+    "    vmax, Km, k2 = lineweaver_burk_derive(m, b, E0)\n",
+    "    return {'m': m, 'b': b, 'vmax': vmax, 'Km': Km, 'k2': k2, 'rss': rss}\n",
+    "\n",
+    "def lineweaver_burk_batch(S, v, offsets, E0=0.028):\n",
+    "    \"\"\"Fit every series of a struct-of-arrays batch; each series needs at least 2 points.\"\"\"\n",
+    "    return lineweaver_burk_solve(*lineweaver_burk_sums(S, v, offsets), E0=E0)\n",
+    "\n",
+    "# Pepsin data as a batch of one series\n",
+    "S, v = np.genfromtxt('pepsin.txt', unpack=True, skip_header=4)  # comments, blank line, column titles\n",
+    "fit = lineweaver_burk_batch(S, v, np.array([0, len(S)]))\n",
+    "\n",
+    "print(f\"vmax = {fit['vmax'][0]:.4f} mM/s\")\n",
+    "print(f\"Km   = {fit['Km'][0]:.4f} mM\")\n",
+    "print(f\"k2   = {fit['k2'][0]:.4f} s^-1\")"
+   ]
+  },
+  {
+   "cell_type": "markdown",
+   "id": "16b2fc81-fa9f-441f-a540-ab9fc912b908",
+   "metadata": {},
+   "source": [
+    "To measure throughput we generate synthetic plates from the pepsin parameters with 2% multiplicative noise on $v$, then compare the batch engine with one `lstsq` call per series."
+   ]
+  },
+  {
+   "cell_type": "code",
+   "execution_count": 85,
+   "id": "7d6e9aeb-4f86-4dd4-97d2-ae57b073754b",
+   "metadata": {},
+   "outputs": [
+    {
+     "name": "stdout",
+     "output_type": "stream",
+     "text": [
+      "max |dKm| vs lstsq : 1.28e-15 mM\n",
+      "batch engine       :    3,995,560 series/s\n",
+      "lstsq per series   :       46,657 series/s\n",
+      "speed-up           : 86x\n"
+     ]
+    }
+   ],
+   "source": [
+    "import time\n",
+    "\n",
+    "def synthetic_plate(n_series, n_points=7, vmax=0.0145, Km=0.3267, noise=0.02, seed=0):\n",
+    "    \"\"\"Struct-of-arrays batch of Michaelis-Menten series with random Km/vmax spread.\"\"\"\n",
+    "    rng = np.random.default_rng(seed)\n",
+    "    S_grid = np.geomspace(0.1, 20.0, n_points)\n",
+    "    vmax_j = vmax * rng.uniform(0.5, 1.5, n_series)\n",
+    "    Km_j = Km * rng.uniform(0.5, 1.5, n_series)\n",
+    "    S = np.tile(S_grid, n_series)\n",
+    "    v_true = np.repeat(vmax_j, n_points) * S / (np.repeat(Km_j, n_points) + S)\n",
+    "    v = v_true * (1 + noise * rng.standard_normal(S.size))\n",
+    "    offsets = np.arange(n_series + 1) * n_points\n",
+    "    return S, v, offsets\n",
+    "\n",
+    "def lstsq_loop(S, v, offsets, E0=0.028):\n",
+    "    vmax = np.empty(len(offsets) - 1)\n",
+    "    Km = np.empty_like(vmax)\n",
+    "    for j in range(len(vmax)):\n",
+    "        x = 1 / S[offsets[j]:offsets[j + 1]]\n",
+    "        y = 1 / v[offsets[j]:offsets[j + 1]]\n",
+    "        A = np.vstack([x, np.ones_like(x)]).T\n",
+    "        m, b = np.linalg.lstsq(A, y, rcond=None)[0]\n",
+    "        vmax[j] = 1 / b\n",
+    "        Km[j] = m * vmax[j]\n",
+    "    return {'vmax': vmax, 'Km': Km, 'k2': vmax / E0}\n",
+    "\n",
+    "n_series = 100_000\n",
+    "S_b, v_b, off_b = synthetic_plate(n_series)\n",
+    "\n",
+    "t0 = time.perf_counter()\n",
+    "fit_b = lineweaver_burk_batch(S_b, v_b, off_b)\n",
+    "t_batch = time.perf_counter() - t0\n",
+    "\n",
+    "n_loop = 5_000\n",
+    "t0 = time.perf_counter()\n",
+    "fit_l = lstsq_loop(S_b, v_b, off_b[:n_loop + 1])\n",
+    "t_loop = time.perf_counter() - t0\n",
+    "\n",
+    "print(f\"max |dKm| vs lstsq : {np.max(np.abs(fit_b['Km'][:n_loop] - fit_l['Km'])):.2e} mM\")\n",
+    "print(f\"batch engine       : {n_series / t_batch:12,.0f} series/s\")\n",
+    "print(f\"lstsq per series   : {n_loop / t_loop:12,.0f} series/s\")\n",
+    "print(f\"speed-up           : {(n_series / t_batch) / (n_loop / t_loop):.0f}x\")"
+   ]
+  },
+  {
+   "cell_type": "markdown",
+   "id": "5a5d80f3-8cf6-4a8b-93d2-035af06ba5c5",
+   "metadata": {},
+   "source": [
+    "### Step 4. Direct nonlinear fit of the Michaelis-Menten hyperbola\n",
+    "The Lineweaver-Burk transform $y=1/v$ stretches the error of the smallest rates: the $[S]=0.1\\;mM$, $v=0.00339\\;mM\\,s^{-1}$ row sits furthest from the origin and dominates the slope. Fitting $v=\\frac{V_{max}[S]}{K_M+[S]}$ directly weights every measurement equally. We minimise\n",
+    "<p align='center'>\n",
+    "    $$RSS(V_{max},K_M)=\\sum_{i=1}^{n}\\left(v_i-\\frac{V_{max}[S]_i}{K_M+[S]_i}\\right)^2$$\n",
+    "</p>\n",
+    "with the Levenberg-Marquardt method, using the analytic Jacobian\n",
+    "<p align='center'>\n",
+    "    $$\\frac{\\partial v}{\\partial V_{max}}=\\frac{[S]}{K_M+[S]},\\quad \\frac{\\partial v}{\\partial K_M}=-\\frac{V_{max}[S]}{(K_M+[S])^2}$$\n",
+    "</p>\n",
+    "Each iteration solves the damped $2\\times2$ normal equations $(J^TJ+\\lambda\\,\\mathrm{diag}(J^TJ))\\,\\delta=J^Tr$ in closed form, so a whole batch of series is updated at once and every series keeps its own damping $\\lambda$. The Lineweaver-Burk estimate from Step 3 is the starting guess."
+   ]
+  },
+  {
+   "cell_type": "code",
+   "execution_count": 86,
+   "id": "8e2222c3-f4b2-48f5-966e-9306301ef2d6",
+   "metadata": {},
+   "outputs": [
+    {
+     "name": "stdout",
+     "output_type": "stream",
+     "text": [
+      "              Lineweaver-Burk   direct (LM)\n",
+      "vmax (mM/s) :         0.0145        0.0145\n",
+      "Km   (mM)   :         0.3267        0.3268\n",
+      "k2   (s^-1) :         0.5166        0.5166\n",
+      "LM iterations: 17\n"
+     ]
+    }
+   ],
+   "source": [
+    "def mm_initial_guess(S, v, offsets):\n",
+    "    \"\"\"Lineweaver-Burk estimate, falling back to max(v) and the mean [S] when it is unphysical.\"\"\"\n",
+    "    fit = lineweaver_burk_batch(S, v, offsets)\n",
+    "    vmax0, Km0 = fit['vmax'], fit['Km']\n",
+    "    bad = ~(np.isfinite(vmax0) & np.isfinite(Km0) & (vmax0 > 0) & (Km0 > 0))\n",
+    "    if bad.any():\n",
+    "        starts = offsets[:-1]\n",
+    "        vmax0 = np.where(bad, np.maximum.reduceat(v, starts), vmax0)\n",
+    "        Km0 = np.where(bad, np.add.reduceat(S, starts) / np.diff(offsets), Km0)\n",
+    "    return vmax0, Km0\n",
+    "\n",
+    "def mm_lm_batch(S, v, offsets, vmax0, Km0, E0=0.028, max_iter=100, tol=1e-12):\n",
+    "    \"\"\"Levenberg-Marquardt fit of v = vmax [S]/(Km + [S]) for every series of a batch.\"\"\"\n",
+    "    starts = offsets[:-1]\n",
+    "    n_series = len(starts)\n",
+    "    seg = np.repeat(np.arange(n_series), np.diff(offsets))\n",
+    "    vmax, Km = vmax0.astype(float), Km0.astype(float)\n",
+    "    lam = np.full(n_series, 1e-3)\n",
+    "    r = v - vmax[seg] * S / (Km[seg] + S)\n",
+    "    rss = np.add.reduceat(r * r, starts)\n",
+    "    iterations = np.zeros(n_series, dtype=int)\n",
+    "    active = np.ones(n_series, dtype=bool)\n",
+    "    for _ in range(max_iter):\n",
+    "        # Analytic Jacobian and the damped 2x2 normal equations per series\n",
+    "        d = 1 / (Km[seg] + S)\n",
+    "        J_v = S * d\n",
+    "        J_K = -vmax[seg] * J_v * d\n",
+    "        a = np.add.reduceat(J_v * J_v, starts) * (1 + lam)\n",
+    "        c = np.add.reduceat(J_K * J_K, starts) * (1 + lam)\n",
+    "        b = np.add.reduceat(J_v * J_K, starts)\n",
+    "        g_v = np.add.reduceat(J_v * r, starts)\n",
+    "        g_K = np.add.reduceat(J_K * r, starts)\n",
+    "        det = a * c - b * b\n",
+    "        vmax_t = vmax + np.where(active, (c * g_v - b * g_K) / det, 0)\n",
+    "        Km_t = Km + np.where(active, (a * g_K - b * g_v) / det, 0)\n",
+    "\n",
+    "        # Accept steps that lower the RSS, otherwise raise the damping\n",
+    "        r_t = v - vmax_t[seg] * S / (Km_t[seg] + S)\n",
+    "        rss_t = np.add.reduceat(r_t * r_t, starts)\n",
+    "        better = active & (Km_t > 0) & (rss_t < rss)\n",
+    "        converged = better & (rss - rss_t <= tol * rss)\n",
+    "        vmax = np.where(better, vmax_t, vmax)\n",
+    "        Km = np.where(better, Km_t, Km)\n",
+    "        r = np.where(better[seg], r_t, r)\n",
+    "        rss = np.where(better, rss_t, rss)\n",
+    "        lam = np.where(better, lam / 10, lam * 10)\n",
+    "        iterations += active\n",
+    "        active &= ~converged & (lam < 1e10)\n",
+    "        if not active.any():\n",
+    "            break\n",
+    "    return {'vmax': vmax, 'Km': Km, 'k2': vmax / E0, 'rss': rss, 'iterations': iterations}\n",
+    "\n",
+    "def mm_fit_batch(S, v, offsets, E0=0.028, **kwargs):\n",
+    "    \"\"\"Direct nonlinear fit seeded with the Lineweaver-Burk estimate.\"\"\"\n",
+    "    vmax0, Km0 = mm_initial_guess(S, v, offsets)\n",
+    "    return mm_lm_batch(S, v, offsets, vmax0, Km0, E0=E0, **kwargs)\n",
+    "\n",
+    "# Pepsin: Lineweaver-Burk vs direct fit\n",
+    "offsets = np.array([0, len(S)])\n",
+    "lb = lineweaver_burk_batch(S, v, offsets)\n",
+    "nl = mm_fit_batch(S, v, offsets)\n",
+    "\n",
+    "print(\"              Lineweaver-Burk   direct (LM)\")\n",
+    "print(f\"vmax (mM/s) : {lb['vmax'][0]:14.4f} {nl['vmax'][0]:13.4f}\")\n",
+    "print(f\"Km   (mM)   : {lb['Km'][0]:14.4f} {nl['Km'][0]:13.4f}\")\n",
+    "print(f\"k2   (s^-1) : {lb['k2'][0]:14.4f} {nl['k2'][0]:13.4f}\")\n",
+    "print(f\"LM iterations: {nl['iterations'][0]}\")"
+   ]
+  },
+  {
+   "cell_type": "markdown",
+   "id": "0ea2068f-be01-48da-bd64-f8bdd5d531dc",
+   "metadata": {},
+   "source": [
+    "Series in a batch converge after very different numbers of iterations, so a static split of the batch over threads leaves cores idle while one thread finishes its slow chunks. The batch is therefore cut into chunks that are dealt to per-worker deques; a worker pops from the back of its own deque and, once empty, steals from the front of another worker's deque. NumPy releases the GIL inside its vector kernels, so the chunks run concurrently on plain threads.\n",
+    "\n",
+    "The benchmark reports fits per second for every thread count up to the number of cores. The outputs below were recorded on a single-core machine, so the table has one row and the scaling across cores was not measured."
+   ]
+  },
+  {
+   "cell_type": "code",
+   "execution_count": 87,
+   "id": "b09c2fd2-7e8f-4b9c-815b-cd23d94bec91",
+   "metadata": {},
+   "outputs": [],
+   "source": [
+    "import os\n",
+    "import random\n",
+    "import threading\n",
+    "from collections import deque\n",
+    "\n",
+    "class WorkStealingPool:\n",
+    "    \"\"\"Runs independent tasks on per-worker deques with stealing from random victims.\"\"\"\n",
+    "\n",
+    "    def __init__(self, n_workers=None):\n",
+    "        self.n_workers = n_workers or os.cpu_count()\n",
+    "\n",
+    "    def map(self, fn, tasks):\n",
+    "        tasks = list(tasks)\n",
+    "        results = [None] * len(tasks)\n",
+    "        queues = [deque() for _ in range(self.n_workers)]\n",
+    "        for i, task in enumerate(tasks):\n",
+    "            queues[i % self.n_workers].append((i, task))\n",
+    "        errors = []\n",
+    "\n",
+    "        def next_task(w, rng):\n",
+    "            try:\n",
+    "                return queues[w].pop()\n",
+    "            except IndexError:\n",
+    "                pass\n",
+    "            victims = [q for q in range(self.n_workers) if q != w]\n",
+    "            rng.shuffle(victims)\n",
+    "            for q in victims:\n",
+    "                try:\n",
+    "                    return queues[q].popleft()\n",
+    "                except IndexError:\n",
+    "                    continue\n",
+    "            return None\n",
+    "\n",
+    "        def worker(w):\n",
+    "            rng = random.Random(w)\n",
+    "            while not errors:\n",
+    "                item = next_task(w, rng)\n",
+    "                if item is None:\n",
+    "                    return\n",
+    "                i, task = item\n",
+    "                try:\n",
+    "                    results[i] = fn(task)\n",
+    "                except BaseException as e:\n",
+    "                    errors.append(e)\n",
+    "\n",
+    "        threads = [threading.Thread(target=worker, args=(w,)) for w in range(self.n_workers)]\n",
+    "        for t in threads:\n",
+    "            t.start()\n",
+    "        for t in threads:\n",
+    "            t.join()\n",
+    "        if errors:\n",
+    "            raise errors[0]\n",
+    "        return results\n",
+    "\n",
+    "def mm_fit_parallel(S, v, offsets, n_threads=None, chunk=2048, E0=0.028, **kwargs):\n",
+    "    \"\"\"Direct nonlinear fit of a batch, chunked over a work-stealing thread pool.\"\"\"\n",
+    "    n_series = len(offsets) - 1\n",
+    "    out = {k: np.empty(n_series) for k in ('vmax', 'Km', 'k2', 'rss')}\n",
+    "    out['iterations'] = np.empty(n_series, dtype=int)\n",
+    "\n",
+    "    def fit_chunk(j0):\n",
+    "        j1 = min(j0 + chunk, n_series)\n",
+    "        lo, hi = offsets[j0], offsets[j1]\n",
+    "        res = mm_fit_batch(S[lo:hi], v[lo:hi], offsets[j0:j1 + 1] - lo, E0=E0, **kwargs)\n",
+    "        for k, arr in res.items():\n",
+    "            out[k][j0:j1] = arr\n",
+    "\n",
+    "    WorkStealingPool(n_threads).map(fit_chunk, range(0, n_series, chunk))\n",
+    "    return out"
+   ]
+  },
+  {
+   "cell_type": "code",
+   "execution_count": 88,
+   "id": "df2cb42c-0545-4385-b4b0-bf4d5961f72e",
+   "metadata": {},
+   "outputs": [
+    {
+     "name": "stdout",
+     "output_type": "stream",
+     "text": [
+      "threads        fits/s  speed-up\n",
+      "      1       189,015      1.00\n",
+      "only 1 core available: scaling across cores not measured\n",
+      "iterations per series: median 5, max 25\n"
+     ]
+    }
+   ],
+   "source": [
+    "n_series = 200_000\n",
+    "S_b, v_b, off_b = synthetic_plate(n_series, noise=0.05, seed=1)\n",
+    "\n",
+    "threads = sorted({1, 2, 4, 8, 16, 32, 64, os.cpu_count()} & set(range(1, os.cpu_count() + 1)))\n",
+    "print(f\"{'threads':>7}  {'fits/s':>12}  {'speed-up':>8}\")\n",
+    "for n_threads in threads:\n",
+    "    t0 = time.perf_counter()\n",
+    "    nl_b = mm_fit_parallel(S_b, v_b, off_b, n_threads=n_threads)\n",
+    "    dt = time.perf_counter() - t0\n",
+    "    if n_threads == 1:\n",
+    "        t1 = dt\n",
+    "    print(f\"{n_threads:>7}  {n_series / dt:12,.0f}  {t1 / dt:8.2f}\")\n",
+    "if len(threads) == 1:\n",
+    "    print(f\"only {os.cpu_count()} core available: scaling across cores not measured\")\n",
+    "print(f\"iterations per series: median {np.median(nl_b['iterations']):.0f}, max {nl_b['iterations'].max()}\")"
+   ]
+  },
+  {
+   "cell_type": "markdown",
+   "id": "12924e85-9ab4-4195-b56d-c2715f00d8e9",
+   "metadata": {},
+   "source": [
+    "### Step 5. Streaming ingest of large rate tables\n",
+    "`np.genfromtxt('pepsin.txt', unpack=True, skip_header=3)` parses the whole file into Python objects before converting it, relies on a hard-coded header length, and the transform then allocates `x = 1/S` and `y = 1/v` as two more full-size arrays. Instrument exports use the same layout as `pepsin.txt` (`#` comment lines, an optional column-title line, then tab-separated $[S]$ and $v$ columns) but can be several gigabytes.\n",
+    "\n",
+    "The reader below maps the file with `mmap` and\n",
+    "- detects the header by skipping blank lines, `#` comments and a non-numeric column-title line;\n",
+    "- tokenizes the data in fixed-size chunks that end on a line break, using NumPy's C parser (`np.fromstring(..., sep=' ')` treats tabs and `\\r\\n` as separators). Because that parser flattens a chunk into one list of numbers, `count_data_rows` first checks that every non-blank line holds exactly two fields, and the parsed count must be twice the number of rows. A row with a missing or extra column therefore raises instead of shifting every later $[S]$, $v$ pair;\n",
+    "- drops the pages of each finished chunk with `madvise(MADV_DONTNEED)`, so the resident set stays at one chunk regardless of file size.\n",
+    "\n",
+    "Each chunk is reduced straight into the summary statistics of Step 3, so `x` and `y` exist only one chunk at a time."
+   ]
+  },
+  {
+   "cell_type": "code",
+   "execution_count": 89,
+   "id": "923477e1-a98b-4c8a-9801-4ba5eccdd86f",
+   "metadata": {},
+   "outputs": [
+    {
+     "name": "stdout",
+     "output_type": "stream",
+     "text": [
+      "header -> (129, 'S / mM\\t\\tv / mM.s-1')\n",
+      "vmax = 0.0145 mM/s\n",
+      "Km   = 0.3267 mM\n",
+      "k2   = 0.5166 s^-1\n",
+      "malformed table -> row at byte 32 has 3 fields; expected 2\n"
+     ]
+    }
+   ],
+   "source": [
+    "import mmap\n",
+    "import tempfile\n",
+    "\n",
+    "_SEPARATOR = np.zeros(256, dtype=bool)\n",
+    "_SEPARATOR[[9, 10, 13, 32]] = True\n",
+    "\n",
+    "def count_data_rows(chunk, offset=0, block=1 << 20):\n",
+    "    \"\"\"Number of non-blank lines in a chunk that starts on a line boundary.\n",
+    "\n",
+    "    Raises ValueError at the first line that does not hold exactly two fields. The\n",
+    "    chunk is scanned in blocks of about `block` bytes to keep the masks small.\"\"\"\n",
+    "    data = np.frombuffer(chunk, dtype=np.uint8)\n",
+    "    n_rows, pos = 0, 0\n",
+    "    while pos < data.size:\n",
+    "        end = min(pos + block, data.size)\n",
+    "        if end < data.size:\n",
+    "            cut = chunk.rfind(b'\\n', pos, end)\n",
+    "            end = cut + 1 if cut >= pos else chunk.find(b'\\n', end) + 1 or data.size\n",
+    "        piece = data[pos:end]\n",
+    "        sep = _SEPARATOR[piece]\n",
+    "        first = ~sep\n",
+    "        first[1:] &= sep[:-1]\n",
+    "        lines = np.flatnonzero(piece == 10) + 1\n",
+    "        lines = np.concatenate([[0], lines[lines < piece.size]])\n",
+    "        fields = np.add.reduceat(first, lines, dtype=np.intp)\n",
+    "        bad = np.flatnonzero((fields != 0) & (fields != 2))\n",
+    "        if bad.size:\n",
+    "            k = bad[0]\n",
+    "            raise ValueError(f\"row at byte {offset + pos + lines[k]} has {fields[k]} fields; expected 2\")\n",
+    "        n_rows += np.count_nonzero(fields)\n",
+    "        pos = end\n",
+    "    return n_rows\n",
+    "\n",
+    "def rate_table_header(buf):\n",
+    "    \"\"\"Byte offset of the first data row and the column titles (if any) of a rate table.\"\"\"\n",
+    "    pos, titles = 0, None\n",
+    "    while pos < len(buf):\n",
+    "        end = buf.find(b'\\n', pos)\n",
+    "        end = len(buf) if end < 0 else end + 1\n",
+    "        line = buf[pos:end].strip()\n",
+    "        if line and not line.startswith(b'#'):\n",
+    "            try:\n",
+    "                float(line.split()[0])\n",
+    "                return pos, titles\n",
+    "            except ValueError:\n",
+    "                titles = line.decode(errors='replace')\n",
+    "        pos = end\n",
+    "    return pos, titles\n",
+    "\n",
+    "def iter_rate_chunks(path, chunk_bytes=64 << 20):\n",
+    "    \"\"\"Yield (S, v) arrays for consecutive chunks of a memory-mapped rate table.\"\"\"\n",
+    "    with open(path, 'rb') as f, mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as buf:\n",
+    "        buf.madvise(mmap.MADV_SEQUENTIAL)\n",
+    "        pos, _ = rate_table_header(buf)\n",
+    "        size = len(buf)\n",
+    "        while pos < size:\n",
+    "            end = min(pos + chunk_bytes, size)\n",
+    "            if end < size:\n",
+    "                end = buf.rfind(b'\\n', pos, end) + 1\n",
+    "                if end <= pos:\n",
+    "                    raise ValueError(f\"line longer than chunk_bytes at byte {pos}\")\n",
+    "            chunk = buf[pos:end]\n",
+    "            values = np.fromstring(chunk, sep=' ')\n",
+    "            n_rows = count_data_rows(chunk, pos)\n",
+    "            if values.size != 2 * n_rows:\n",
+    "                raise ValueError(f\"parsed {values.size} numbers from {n_rows} rows starting at byte {pos}\")\n",
+    "            yield values[0::2], values[1::2]\n",
+    "            # Release the pages of the finished chunk from the resident set\n",
+    "            page = pos - pos % mmap.PAGESIZE\n",
+    "            buf.madvise(mmap.MADV_DONTNEED, page, end - page)\n",
+    "            pos = end\n",
+    "\n",
+    "def lineweaver_burk_stream(path, E0=0.028, chunk_bytes=64 << 20):\n",
+    "    \"\"\"Lineweaver-Burk fit of one rate table, accumulated chunk by chunk.\"\"\"\n",
+    "    sums = np.zeros(6)\n",
+    "    for S_c, v_c in iter_rate_chunks(path, chunk_bytes):\n",
+    "        sums += [s[0] for s in lineweaver_burk_sums(S_c, v_c, np.array([0, S_c.size]))]\n",
+    "    return {k: val[0] for k, val in lineweaver_burk_solve(*sums[:, None], E0=E0).items()}\n",
+    "\n",
+    "with open('pepsin.txt', 'rb') as f:\n",
+    "    print('header ->', rate_table_header(f.read()))\n",
+    "fit = lineweaver_burk_stream('pepsin.txt')\n",
+    "print(f\"vmax = {fit['vmax']:.4f} mM/s\")\n",
+    "print(f\"Km   = {fit['Km']:.4f} mM\")\n",
+    "print(f\"k2   = {fit['k2']:.4f} s^-1\")\n",
+    "\n",
+    "# A table with an extra column on one row and a missing column on another\n",
+    "with tempfile.NamedTemporaryFile('w', suffix='.txt', delete=False) as f:\n",
+    "    f.write('S / mM\\t\\tv / mM.s-1\\n0.1\\t\\t0.00339\\n0.2\\t\\t0.00549\\t\\t7\\n0.5\\t\\t1.0\\n0.3\\n')\n",
+    "try:\n",
+    "    list(iter_rate_chunks(f.name))\n",
+    "except ValueError as e:\n",
+    "    print('malformed table ->', e)\n",
+    "os.remove(f.name)"
+   ]
+  },
+  {
+   "cell_type": "markdown",
+   "id": "28724b9e-acda-4035-ae05-044bd3af4546",
+   "metadata": {},
+   "source": [
+    "For the comparison we write a synthetic table in the `pepsin.txt` format and run each loader in a forked process, reporting the peak resident set above the process baseline (`VmHWM` after resetting it through `/proc/self/clear_refs`). Set `size_mb = 5_000` for the full 5 GB run; `genfromtxt` is then limited to a slice of the file because it would need tens of gigabytes of memory."
+   ]
+  },
+  {
+   "cell_type": "code",
+   "execution_count": 90,
+   "id": "bfa8eb38-b9f2-47f8-bd3c-338372c19ccd",
+   "metadata": {},
+   "outputs": [
+    {
+     "name": "stdout",
+     "output_type": "stream",
+     "text": [
+      "loader        file MB     MB/s  peak RSS MB       Km\n",
+      "genfromtxt         20      8.0        392.1   0.3266\n",
+      "mmap stream        20     44.2         63.4   0.3266\n",
+      "mmap stream       207     44.0         77.6   0.3267\n"
+     ]
+    }
+   ],
+   "source": [
+    "import multiprocessing as mp\n",
+    "import tempfile\n",
+    "\n",
+    "def write_synthetic_rate_table(path, size_mb, vmax=0.0145, Km=0.3267, noise=0.02, seed=0):\n",
+    "    \"\"\"Write a pepsin.txt-style table of roughly size_mb megabytes.\"\"\"\n",
+    "    rng = np.random.default_rng(seed)\n",
+    "    rows = 1_000_000\n",
+    "    with open(path, 'w') as f:\n",
+    "        f.write('# Synthetic reaction rates, v (in mM.s-1), for Michaelis-Menten kinetics\\n\\n')\n",
+    "        f.write('S / mM\\t\\tv / mM.s-1\\n')\n",
+    "        while f.tell() < size_mb * 1e6:\n",
+    "            S_r = rng.uniform(0.1, 20.0, rows)\n",
+    "            v_r = vmax * S_r / (Km + S_r) * (1 + noise * rng.standard_normal(rows))\n",
+    "            np.savetxt(f, np.column_stack([S_r, v_r]), fmt='%.6g', delimiter='\\t\\t')\n",
+    "\n",
+    "def _peak_rss_worker(load, path, conn):\n",
+    "    def status(key):\n",
+    "        with open('/proc/self/status') as f:\n",
+    "            return next(int(l.split()[1]) for l in f if l.startswith(key))\n",
+    "    with open('/proc/self/clear_refs', 'w') as f:\n",
+    "        f.write('5')\n",
+    "    base = status('VmRSS:')\n",
+    "    t0 = time.perf_counter()\n",
+    "    Km = load(path)\n",
+    "    conn.send((time.perf_counter() - t0, (status('VmHWM:') - base) / 1024, Km))\n",
+    "\n",
+    "def measure_loader(load, path):\n",
+    "    \"\"\"Wall time, peak RSS above baseline (MB) and fitted Km of load(path) in a fresh process.\"\"\"\n",
+    "    recv, send = mp.Pipe(duplex=False)\n",
+    "    p = mp.get_context('fork').Process(target=_peak_rss_worker, args=(load, path, send))\n",
+    "    p.start()\n",
+    "    result = recv.recv()\n",
+    "    p.join()\n",
+    "    return result\n",
+    "\n",
+    "def load_genfromtxt(path):\n",
+    "    S, v = np.genfromtxt(path, unpack=True, skip_header=3)\n",
+    "    x, y = 1 / S, 1 / v\n",
+    "    m, b = np.linalg.lstsq(np.vstack([x, np.ones_like(x)]).T, y, rcond=None)[0]\n",
+    "    return m / b\n",
+    "\n",
+    "def load_stream(path):\n",
+    "    return lineweaver_burk_stream(path, chunk_bytes=16 << 20)['Km']\n",
+    "\n",
+    "size_mb = 200\n",
+    "with tempfile.TemporaryDirectory() as tmp:\n",
+    "    big = os.path.join(tmp, 'rates.txt')\n",
+    "    write_synthetic_rate_table(big, size_mb)\n",
+    "    small = os.path.join(tmp, 'rates_small.txt')\n",
+    "    with open(big, 'rb') as src, open(small, 'wb') as dst:\n",
+    "        dst.write(src.read(20_000_000))\n",
+    "        dst.write(src.readline())\n",
+    "    mb_big = os.path.getsize(big) / 1e6\n",
+    "    mb_small = os.path.getsize(small) / 1e6\n",
+    "\n",
+    "    print(f\"{'loader':<12} {'file MB':>8} {'MB/s':>8} {'peak RSS MB':>12} {'Km':>8}\")\n",
+    "    for name, load, path, mb in [('genfromtxt', load_genfromtxt, small, mb_small),\n",
+    "                                 ('mmap stream', load_stream, small, mb_small),\n",
+    "                                 ('mmap stream', load_stream, big, mb_big)]:\n",
+    "        dt, rss, Km = measure_loader(load, path)\n",
+    "        print(f\"{name:<12} {mb:8.0f} {mb / dt:8.1f} {rss:12.1f} {Km:8.4f}\")"
+   ]
+  },
+  {
+   "cell_type": "markdown",
+   "id": "c1c556d4-d132-4893-92cb-0d515636004e",
+   "metadata": {},
+   "source": [
+    "### Step 6. A binary columnar archive for datasets and fit results\n",
+    "Every run re-parses `pepsin.txt` and re-derives $v_{max}$, $K_M$ and $k_2$, and the results only ever reach `stdout`. To keep past experiments and their fits, we store them in a small versioned container (`.kinx`) that is read through `mmap`:\n",
+    "\n",
+    "| Section | Content |\n",
+    "| ------- | ------- |\n",
+    "| header | magic `KINX`, format version, number of columns, number of series, offset of the column directory |\n",
+    "| columns | 64-byte aligned little-endian arrays: `offsets`, `S`, `v`, `series_id`, `id_order`, `E0`, `temperature`, `pH`, `vmax`, `Km`, `k2`, `rss`, `cov` and a UTF-8 JSON block of global metadata |\n",
+    "| directory | one entry per column: name, dtype, byte offset, rows and columns |\n",
+    "\n",
+    "$[S]$ and $v$ of all series are stored back to back with the `offsets` of Step 3, so opening an archive costs only the header and directory reads; a series is located by binary search of its ID through `id_order` and read straight from the mapped pages. The fitted parameters are stored with their covariance from the direct fit of Step 4,\n",
+    "<p align='center'>\n",
+    "    $$\\mathrm{cov}(V_{max},K_M)=\\frac{RSS}{n-2}\\,(J^TJ)^{-1}$$\n",
+    "</p>"
+   ]
+  },
+  {
+   "cell_type": "code",
+   "execution_count": 91,
+   "id": "ed3e6c5e-e7ad-43f6-9308-8e65e1a080fb",
+   "metadata": {},
+   "outputs": [
+    {
+     "name": "stdout",
+     "output_type": "stream",
+     "text": [
+      "pepsin - 1662 bytes\n",
+      "vmax = 0.0145 +/- 2e-06 mM/s\n",
+      "Km   = 0.3268 +/- 0.0002 mM\n",
+      "k2   = 0.5166 s^-1 at 35 C, pH 2\n",
+      "rejected: series IDs must be unique, lookup by ID would be ambiguous\n"
+     ]
+    }
+   ],
+   "source": [
+    "import json\n",
+    "import struct\n",
+    "\n",
+    "KINX_MAGIC = b'KINX'\n",
+    "KINX_VERSION = 1\n",
+    "KINX_HEADER = struct.Struct('<4sHHQQ')      # magic, version, n_columns, n_series, directory offset\n",
+    "KINX_ENTRY = struct.Struct('<16s8sQQQ')     # name, dtype, offset, rows, cols\n",
+    "KINX_ALIGN = 64\n",
+    "\n",
+    "def mm_covariance(S, v, offsets, vmax, Km):\n",
+    "    \"\"\"Per-series 2x2 covariance of (vmax, Km) for the direct Michaelis-Menten fit.\"\"\"\n",
+    "    starts = offsets[:-1]\n",
+    "    n = np.diff(offsets)\n",
+    "    seg = np.repeat(np.arange(len(starts)), n)\n",
+    "    d = 1 / (Km[seg] + S)\n",
+    "    J_v = S * d\n",
+    "    J_K = -vmax[seg] * J_v * d\n",
+    "    r = v - vmax[seg] * J_v\n",
+    "    a = np.add.reduceat(J_v * J_v, starts)\n",
+    "    b = np.add.reduceat(J_v * J_K, starts)\n",
+    "    c = np.add.reduceat(J_K * J_K, starts)\n",
+    "    s2 = np.add.reduceat(r * r, starts) / np.maximum(n - 2, 1)\n",
+    "    det = a * c - b * b\n",
+    "    cov = np.empty((len(starts), 2, 2))\n",
+    "    cov[:, 0, 0] = s2 * c / det\n",
+    "    cov[:, 0, 1] = cov[:, 1, 0] = -s2 * b / det\n",
+    "    cov[:, 1, 1] = s2 * a / det\n",
+    "    return cov\n",
+    "\n",
+    "def write_kinetics_archive(path, S, v, offsets, fit, series_id=None, E0=0.028,\n",
+    "                           temperature=np.nan, pH=np.nan, meta=None):\n",
+    "    \"\"\"Write series, per-series conditions and fit results to a .kinx archive.\"\"\"\n",
+    "    n_series = len(offsets) - 1\n",
+    "    series_id = np.arange(n_series) if series_id is None else np.asarray(series_id)\n",
+    "    if len(series_id) != n_series:\n",
+    "        raise ValueError(f\"{len(series_id)} series IDs for {n_series} series\")\n",
+    "    if np.unique(series_id).size != n_series:\n",
+    "        raise ValueError(\"series IDs must be unique, lookup by ID would be ambiguous\")\n",
+    "    per_series = lambda x: np.broadcast_to(np.asarray(x, dtype='<f8'), (n_series,))\n",
+    "    columns = {\n",
+    "        'offsets': np.asarray(offsets, dtype='<i8'),\n",
+    "        'S': np.asarray(S, dtype='<f8'),\n",
+    "        'v': np.asarray(v, dtype='<f8'),\n",
+    "        'series_id': series_id.astype('<i8'),\n",
+    "        'id_order': np.argsort(series_id, kind='stable').astype('<i8'),\n",
+    "        'E0': per_series(E0),\n",
+    "        'temperature': per_series(temperature),\n",
+    "        'pH': per_series(pH),\n",
+    "        'vmax': per_series(fit['vmax']),\n",
+    "        'Km': per_series(fit['Km']),\n",
+    "        'k2': per_series(fit['k2']),\n",
+    "        'rss': per_series(fit['rss']),\n",
+    "        'cov': np.asarray(fit['cov'], dtype='<f8').reshape(n_series, 4),\n",
+    "        'meta': np.frombuffer(json.dumps(meta or {}).encode(), dtype='u1'),\n",
+    "    }\n",
+    "    entries = []\n",
+    "    with open(path, 'wb') as f:\n",
+    "        f.write(b'\\0' * KINX_HEADER.size)\n",
+    "        for name, col in columns.items():\n",
+    "            f.write(b'\\0' * (-f.tell() % KINX_ALIGN))\n",
+    "            entries.append(KINX_ENTRY.pack(name.encode(), col.dtype.str.encode(), f.tell(),\n",
+    "                                           col.shape[0], col.shape[1] if col.ndim > 1 else 1))\n",
+    "            f.write(np.ascontiguousarray(col).tobytes())\n",
+    "        directory = f.tell()\n",
+    "        f.write(b''.join(entries))\n",
+    "        f.seek(0)\n",
+    "        f.write(KINX_HEADER.pack(KINX_MAGIC, KINX_VERSION, len(entries), n_series, directory))\n",
+    "\n",
+    "class KineticsArchive:\n",
+    "    \"\"\"Memory-mapped, read-only view of a .kinx archive with lookup by series ID.\"\"\"\n",
+    "\n",
+    "    def __init__(self, path):\n",
+    "        with open(path, 'rb') as f:\n",
+    "            self._buf = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)\n",
+    "        magic, version, n_columns, self.n_series, directory = KINX_HEADER.unpack_from(self._buf)\n",
+    "        if magic != KINX_MAGIC:\n",
+    "            raise ValueError(f\"{path} is not a .kinx archive\")\n",
+    "        if version > KINX_VERSION:\n",
+    "            raise ValueError(f\"{path} has format version {version}, newest supported is {KINX_VERSION}\")\n",
+    "        self.columns = {}\n",
+    "        for i in range(n_columns):\n",
+    "            name, dtype, offset, rows, cols = KINX_ENTRY.unpack_from(self._buf, directory + i * KINX_ENTRY.size)\n",
+    "            arr = np.frombuffer(self._buf, dtype=dtype.rstrip(b'\\0').decode(), count=rows * cols, offset=offset)\n",
+    "            self.columns[name.rstrip(b'\\0').decode()] = arr.reshape(rows, cols) if cols > 1 else arr\n",
+    "        self.meta = json.loads(self.columns.pop('meta').tobytes())\n",
+    "\n",
+    "    def __getitem__(self, name):\n",
+    "        return self.columns[name]\n",
+    "\n",
+    "    def index(self, series_id):\n",
+    "        \"\"\"Row of series_id in the archive.\"\"\"\n",
+    "        ids, order = self.columns['series_id'], self.columns['id_order']\n",
+    "        k = np.searchsorted(ids, series_id, sorter=order)\n",
+    "        if k == len(order) or ids[order[k]] != series_id:\n",
+    "            raise KeyError(series_id)\n",
+    "        return order[k]\n",
+    "\n",
+    "    def series(self, series_id):\n",
+    "        \"\"\"([S], v) of one series as views into the mapped file.\"\"\"\n",
+    "        j = self.index(series_id)\n",
+    "        lo, hi = self.columns['offsets'][j:j + 2]\n",
+    "        return self.columns['S'][lo:hi], self.columns['v'][lo:hi]\n",
+    "\n",
+    "    def fit(self, series_id):\n",
+    "        \"\"\"Stored fit parameters, conditions and (vmax, Km) covariance of one series.\"\"\"\n",
+    "        j = self.index(series_id)\n",
+    "        out = {k: self.columns[k][j] for k in ('vmax', 'Km', 'k2', 'rss', 'E0', 'temperature', 'pH')}\n",
+    "        out['cov'] = self.columns['cov'][j].reshape(2, 2)\n",
+    "        return out\n",
+    "\n",
+    "    def close(self):\n",
+    "        # The mapping itself is released once no array view into it is alive\n",
+    "        self.columns.clear()\n",
+    "        self._buf = None\n",
+    "\n",
+    "    def __enter__(self):\n",
+    "        return self\n",
+    "\n",
+    "    def __exit__(self, *exc):\n",
+    "        self.close()\n",
+    "\n",
+    "def fit_for_archive(S, v, offsets, E0=0.028):\n",
+    "    \"\"\"Direct fit plus covariance, in the form write_kinetics_archive expects.\"\"\"\n",
+    "    fit = mm_fit_batch(S, v, offsets, E0=E0)\n",
+    "    fit['cov'] = mm_covariance(S, v, offsets, fit['vmax'], fit['Km'])\n",
+    "    return fit\n",
+    "\n",
+    "# Archive the pepsin experiment and read it back\n",
+    "with tempfile.TemporaryDirectory() as tmp:\n",
+    "    path = os.path.join(tmp, 'pepsin.kinx')\n",
+    "    offsets = np.array([0, len(S)])\n",
+    "    write_kinetics_archive(path, S, v, offsets, fit_for_archive(S, v, offsets), series_id=[195],\n",
+    "                           E0=0.028, temperature=35.0, pH=2.0,\n",
+    "                           meta={'enzyme': 'pepsin', 'substrate': 'bovine serum albumin',\n",
+    "                                 'units': {'S': 'mM', 'v': 'mM.s-1'}})\n",
+    "    with KineticsArchive(path) as arc:\n",
+    "        res = arc.fit(195)\n",
+    "        print(arc.meta['enzyme'], '-', os.path.getsize(path), 'bytes')\n",
+    "        print(f\"vmax = {res['vmax']:.4f} +/- {np.sqrt(res['cov'][0, 0]):.1g} mM/s\")\n",
+    "        print(f\"Km   = {res['Km']:.4f} +/- {np.sqrt(res['cov'][1, 1]):.1g} mM\")\n",
+    "        print(f\"k2   = {res['k2']:.4f} s^-1 at {res['temperature']:.0f} C, pH {res['pH']:.0f}\")\n",
+    "    try:\n",
+    "        write_kinetics_archive(path, S, v, np.array([0, 4, len(S)]),\n",
+    "                               fit_for_archive(S, v, np.array([0, 4, len(S)])), series_id=[195, 195])\n",
+    "    except ValueError as err:\n",
+    "        print('rejected:', err)"
+   ]
+  },
+  {
+   "cell_type": "markdown",
+   "id": "f38ab659-6bfd-4098-ab03-dbd002ebbb37",
+   "metadata": {},
+   "source": [
+    "Re-loading an archive of past experiments: the text path parses a table with a series column and refits every series, the binary path maps the archive and reads the stored fits."
+   ]
+  },
+  {
+   "cell_type": "code",
+   "execution_count": 92,
+   "id": "e122f20b-c21f-45d7-84b7-af7b8f674a05",
+   "metadata": {},
+   "outputs": [
+    {
+     "name": "stdout",
+     "output_type": "stream",
+     "text": [
+      "text + refit      :      418.1 ms  (3.6 MB)\n",
+      "kinx open + fits  :      0.364 ms  (4.5 MB)\n",
+      "series lookup     :       3.97 us\n",
+      "max |dKm|         : 5.1e-06 mM\n"
+     ]
+    }
+   ],
+   "source": [
+    "n_series = 20_000\n",
+    "S_b, v_b, off_b = synthetic_plate(n_series, seed=2)\n",
+    "ids_b = np.random.default_rng(2).permutation(10 * n_series)[:n_series]\n",
+    "\n",
+    "with tempfile.TemporaryDirectory() as tmp:\n",
+    "    txt = os.path.join(tmp, 'archive.txt')\n",
+    "    kinx = os.path.join(tmp, 'archive.kinx')\n",
+    "    np.savetxt(txt, np.column_stack([np.repeat(ids_b, np.diff(off_b)), S_b, v_b]),\n",
+    "               fmt=['%d', '%.6g', '%.6g'], delimiter='\\t\\t', header='series\\t\\tS / mM\\t\\tv / mM.s-1')\n",
+    "    write_kinetics_archive(kinx, S_b, v_b, off_b, fit_for_archive(S_b, v_b, off_b), series_id=ids_b)\n",
+    "\n",
+    "    t0 = time.perf_counter()\n",
+    "    sid, S_t, v_t = np.genfromtxt(txt, unpack=True)\n",
+    "    fit_t = fit_for_archive(S_t, v_t, off_b)\n",
+    "    t_text = time.perf_counter() - t0\n",
+    "\n",
+    "    t0 = time.perf_counter()\n",
+    "    with KineticsArchive(kinx) as arc:\n",
+    "        Km_all = arc['Km'].copy()\n",
+    "        t_open = time.perf_counter() - t0\n",
+    "        probe = np.random.default_rng(3).choice(ids_b, 10_000)\n",
+    "        t0 = time.perf_counter()\n",
+    "        for i in probe:\n",
+    "            arc.series(i)\n",
+    "        t_lookup = (time.perf_counter() - t0) / len(probe)\n",
+    "\n",
+    "    print(f\"text + refit      : {t_text * 1e3:10.1f} ms  ({os.path.getsize(txt) / 1e6:.1f} MB)\")\n",
+    "    print(f\"kinx open + fits  : {t_open * 1e3:10.3f} ms  ({os.path.getsize(kinx) / 1e6:.1f} MB)\")\n",
+    "    print(f\"series lookup     : {t_lookup * 1e6:10.2f} us\")\n",
+    "    print(f\"max |dKm|         : {np.max(np.abs(Km_all - fit_t['Km'])):.1e} mM\")"
+   ]
+  },
+  {
+   "cell_type": "markdown",
+   "id": "96992999-082c-424b-b24c-7d5ca40bcef9",
+   "metadata": {},
+   "source": [
+    "### Step 7. Bootstrap and jackknife confidence intervals\n",
+    "The values $v_{max}=0.0145\\;mM\\,s^{-1}$, $K_M=0.3267\\;mM$ and $k_2=0.5166\\;s^{-1}$ are point estimates. A bootstrap resample draws $n$ rows with replacement, which is the same as giving row $i$ an integer weight $w_i$ (how often it was drawn) with $\\sum w_i=n$. The summary statistics of the resample are then weighted sums of per-row terms that never change,\n",
+    "<p align='center'>\n",
+    "    $$\\begin{pmatrix} n & S_x & S_y & S_{xx} & S_{xy} & S_{yy}\\end{pmatrix}_b = w_b^T\\,T,\\quad T_i=\\begin{pmatrix} 1 & x_i & y_i & x_i^2 & x_iy_i & y_i^2\\end{pmatrix}$$\n",
+    "</p>\n",
+    "so a block of $B$ resamples is a single $(B\\times n)(n\\times 6)$ matrix product followed by the closed-form solution of Step 3. The jackknife is cheaper still: the leave-one-out sums are the full sums minus one row of $T$.\n",
+    "\n",
+    "Resamples are generated in fixed-size blocks, and block $k$ always draws from its own Philox counter-based generator, seeded from the pair (seed, $k$) through a `SeedSequence` so that the streams of different blocks do not overlap. The intervals therefore do not depend on how many threads run the blocks or in which order they finish."
+   ]
+  },
+  {
+   "cell_type": "code",
+   "execution_count": 93,
+   "id": "0fad6ae6-3e6d-4c50-9cc6-bb811d4c7869",
+   "metadata": {},
+   "outputs": [
+    {
+     "name": "stdout",
+     "output_type": "stream",
+     "text": [
+      "95% bootstrap percentile intervals (1e5 resamples)\n",
+      "vmax = 0.01446 mM/s  [0.01446, 0.01447]  jackknife SE 4e-06\n",
+      "Km   = 0.3267 mM     [0.3265, 0.3271]  jackknife SE 0.0003\n",
+      "k2   = 0.5166 s^-1   [0.5164, 0.5168]  jackknife SE 0.0001\n",
+      "degenerate resamples: 0.00%\n"
+     ]
+    }
+   ],
+   "source": [
+    "def lineweaver_burk_terms(S, v):\n",
+    "    \"\"\"Per-row terms (1, x, y, x^2, xy, y^2) whose column sums are the fit statistics.\"\"\"\n",
+    "    x, y = 1 / S, 1 / v\n",
+    "    return np.column_stack([np.ones_like(x), x, y, x * x, x * y, y * y])\n",
+    "\n",
+    "def bootstrap_block(T, k, size, seed):\n",
+    "    \"\"\"Lineweaver-Burk fits of resample block k, drawn from its own Philox stream.\"\"\"\n",
+    "    rng = np.random.Generator(np.random.Philox(np.random.SeedSequence([seed, k])))\n",
+    "    n = T.shape[0]\n",
+    "    weights = rng.multinomial(n, np.full(n, 1 / n), size=size).astype(float)\n",
+    "    return lineweaver_burk_solve(*(weights @ T).T)\n",
+    "\n",
+    "def lineweaver_burk_bootstrap(S, v, n_resamples=100_000, seed=0, block=4096, n_threads=None,\n",
+    "                              level=0.95, E0=0.028):\n",
+    "    \"\"\"Percentile bootstrap intervals for vmax, Km and k2.\"\"\"\n",
+    "    T = lineweaver_burk_terms(S, v)\n",
+    "    blocks = [(k, min(block, n_resamples - k * block)) for k in range(-(-n_resamples // block))]\n",
+    "    fits = WorkStealingPool(n_threads).map(lambda kb: bootstrap_block(T, kb[0], kb[1], seed), blocks)\n",
+    "    q = 100 * np.array([(1 - level) / 2, (1 + level) / 2])\n",
+    "    draws = {p: np.concatenate([f[p] for f in fits]) for p in ('vmax', 'Km')}\n",
+    "    out = {p: np.nanpercentile(d, q) for p, d in draws.items()}\n",
+    "    out['degenerate'] = np.mean(~(np.isfinite(draws['vmax']) & np.isfinite(draws['Km'])))\n",
+    "    out['k2'] = out['vmax'] / E0\n",
+    "    return out\n",
+    "\n",
+    "def lineweaver_burk_jackknife(S, v, E0=0.028):\n",
+    "    \"\"\"Leave-one-out estimates, standard errors and bias-corrected values for vmax, Km and k2.\"\"\"\n",
+    "    T = lineweaver_burk_terms(S, v)\n",
+    "    full = lineweaver_burk_solve(*T.sum(axis=0), E0=E0)\n",
+    "    loo = lineweaver_burk_solve(*(T.sum(axis=0) - T).T, E0=E0)\n",
+    "    n = len(S)\n",
+    "    out = {}\n",
+    "    for p in ('vmax', 'Km', 'k2'):\n",
+    "        mean = loo[p].mean()\n",
+    "        out[p] = {'se': np.sqrt((n - 1) / n * np.sum((loo[p] - mean) ** 2)),\n",
+    "                  'bias_corrected': n * full[p] - (n - 1) * mean}\n",
+    "    return out\n",
+    "\n",
+    "point = lineweaver_burk_solve(*lineweaver_burk_terms(S, v).sum(axis=0))\n",
+    "ci = lineweaver_burk_bootstrap(S, v, n_resamples=100_000, seed=2026)\n",
+    "jk = lineweaver_burk_jackknife(S, v)\n",
+    "print(\"95% bootstrap percentile intervals (1e5 resamples)\")\n",
+    "print(f\"vmax = {point['vmax']:.5f} mM/s  [{ci['vmax'][0]:.5f}, {ci['vmax'][1]:.5f}]  jackknife SE {jk['vmax']['se']:.1g}\")\n",
+    "print(f\"Km   = {point['Km']:.4f} mM     [{ci['Km'][0]:.4f}, {ci['Km'][1]:.4f}]  jackknife SE {jk['Km']['se']:.1g}\")\n",
+    "print(f\"k2   = {point['k2']:.4f} s^-1   [{ci['k2'][0]:.4f}, {ci['k2'][1]:.4f}]  jackknife SE {jk['k2']['se']:.1g}\")\n",
+    "print(f\"degenerate resamples: {ci['degenerate']:.2%}\")"
+   ]
+  },
+  {
+   "cell_type": "markdown",
+   "id": "8da7262c-7101-413a-b210-9a403d036868",
+   "metadata": {},
+   "source": [
+    "The benchmark checks that the intervals are identical for 1, 3 and 8 workers, which holds whether or not there are that many cores, since the result must not depend on which worker runs which block. It then reports resamples per second for every thread count up to the number of cores. The outputs below were recorded on a single-core machine, so they show one row and the scaling across cores was not measured."
+   ]
+  },
+  {
+   "cell_type": "code",
+   "execution_count": 94,
+   "id": "ef29d2c3-5e81-4c04-bef1-722a45e1d6d8",
+   "metadata": {},
+   "outputs": [
+    {
+     "name": "stdout",
+     "output_type": "stream",
+     "text": [
+      "Km interval identical for 1, 3 and 8 workers: [0.326501, 0.327119]\n",
+      "threads   resamples/s  speed-up  Km interval\n",
+      "      1     1,999,750      1.00  [0.326501, 0.327119]\n",
+      "only 1 core available: scaling across cores not measured\n"
+     ]
+    }
+   ],
+   "source": [
+    "ci_w = [lineweaver_burk_bootstrap(S, v, n_resamples=100_000, seed=2026, n_threads=n)['Km'] for n in (1, 3, 8)]\n",
+    "assert all(np.array_equal(ci, ci_w[0]) for ci in ci_w)\n",
+    "print(f\"Km interval identical for 1, 3 and 8 workers: [{ci_w[0][0]:.6f}, {ci_w[0][1]:.6f}]\")\n",
+    "\n",
+    "n_resamples = 1_000_000\n",
+    "print(f\"{'threads':>7}  {'resamples/s':>12}  {'speed-up':>8}  Km interval\")\n",
+    "for n_threads in threads:\n",
+    "    t0 = time.perf_counter()\n",
+    "    ci_t = lineweaver_burk_bootstrap(S, v, n_resamples=n_resamples, seed=2026, n_threads=n_threads)\n",
+    "    dt = time.perf_counter() - t0\n",
+    "    if n_threads == 1:\n",
+    "        t1, ci_1 = dt, ci_t\n",
+    "    assert np.array_equal(ci_t['Km'], ci_1['Km'])\n",
+    "    print(f\"{n_threads:>7}  {n_resamples / dt:12,.0f}  {t1 / dt:8.2f}  [{ci_t['Km'][0]:.6f}, {ci_t['Km'][1]:.6f}]\")\n",
+    "if len(threads) == 1:\n",
+    "    print(f\"only {os.cpu_count()} core available: scaling across cores not measured\")"
+   ]
+  },
+  {
+   "cell_type": "markdown",
+   "id": "f5298f0b-57e1-46df-8a81-daf0f8855af2",
+   "metadata": {},
+   "source": [
+    "### Step 8. Online fitting of streamed rate measurements\n",
+    "When a rig streams $([S], v)$ pairs, rebuilding `A` and calling `lstsq` after every point repeats all the work. The fit depends only on the running sums, but accumulating raw $S_{xx}$ and $S_x^2$ separately loses precision through cancellation in $\\Delta = nS_{xx}-S_x^2$. Welford's method instead keeps the means and the centred sums\n",
+    "<p align='center'>\n",
+    "    $$\\bar{x},\\;\\bar{y},\\quad C_{xx}=\\sum(x_i-\\bar{x})^2,\\quad C_{xy}=\\sum(x_i-\\bar{x})(y_i-\\bar{y}),\\quad C_{yy}=\\sum(y_i-\\bar{y})^2$$\n",
+    "</p>\n",
+    "which are updated in $O(1)$ when a point is added,\n",
+    "<p align='center'>\n",
+    "    $$\\delta=x-\\bar{x}_{n-1},\\quad \\bar{x}_n=\\bar{x}_{n-1}+\\frac{\\delta}{n},\\quad C_{xy,n}=C_{xy,n-1}+\\delta\\,(y-\\bar{y}_n)$$\n",
+    "</p>\n",
+    "and downdated by running the same recurrence backwards when a point leaves a sliding window. The line is then $m=C_{xy}/C_{xx}$, $b=\\bar{y}-m\\bar{x}$ and $RSS=C_{yy}-mC_{xy}$. A small batch is merged with the pairwise update of Chan et al."
+   ]
+  },
+  {
+   "cell_type": "code",
+   "execution_count": 95,
+   "id": "ce379880-4719-4857-9dbf-03ae8d9534a2",
+   "metadata": {},
+   "outputs": [
+    {
+     "name": "stdout",
+     "output_type": "stream",
+     "text": [
+      "vmax = 0.0145 mM/s\n",
+      "Km   = 0.3267 mM\n",
+      "k2   = 0.5166 s^-1\n",
+      "window Km = 0.327167 mM, batch Km = 0.327167 mM\n"
+     ]
+    }
+   ],
+   "source": [
+    "class OnlineLineweaverBurk:\n",
+    "    \"\"\"O(1) running Lineweaver-Burk fit with point removal for sliding windows.\"\"\"\n",
+    "\n",
+    "    __slots__ = ('n', 'mx', 'my', 'cxx', 'cxy', 'cyy', 'E0')\n",
+    "\n",
+    "    def __init__(self, E0=0.028):\n",
+    "        self.E0 = E0\n",
+    "        self.n = 0\n",
+    "        self.mx = self.my = self.cxx = self.cxy = self.cyy = 0.0\n",
+    "\n",
+    "    def add(self, S, v):\n",
+    "        x, y = 1.0 / S, 1.0 / v\n",
+    "        self.n += 1\n",
+    "        dx = x - self.mx\n",
+    "        dy = y - self.my\n",
+    "        self.mx += dx / self.n\n",
+    "        self.my += dy / self.n\n",
+    "        self.cxx += dx * (x - self.mx)\n",
+    "        self.cxy += dx * (y - self.my)\n",
+    "        self.cyy += dy * (y - self.my)\n",
+    "\n",
+    "    def remove(self, S, v):\n",
+    "        x, y = 1.0 / S, 1.0 / v\n",
+    "        if self.n <= 1:\n",
+    "            self.__init__(self.E0)\n",
+    "            return\n",
+    "        n = self.n - 1\n",
+    "        mx = (self.n * self.mx - x) / n\n",
+    "        my = (self.n * self.my - y) / n\n",
+    "        self.cxx -= (x - mx) * (x - self.mx)\n",
+    "        self.cxy -= (x - mx) * (y - self.my)\n",
+    "        self.cyy -= (y - my) * (y - self.my)\n",
+    "        self.n, self.mx, self.my = n, mx, my\n",
+    "\n",
+    "    def add_many(self, S, v):\n",
+    "        \"\"\"Merge a batch of points in one pairwise update.\"\"\"\n",
+    "        x, y = 1 / np.asarray(S, dtype=float), 1 / np.asarray(v, dtype=float)\n",
+    "        nb = x.size\n",
+    "        if nb == 0:\n",
+    "            return\n",
+    "        mxb, myb = x.mean(), y.mean()\n",
+    "        n = self.n + nb\n",
+    "        dx, dy = mxb - self.mx, myb - self.my\n",
+    "        f = self.n * nb / n\n",
+    "        self.cxx += float(np.sum((x - mxb) ** 2)) + dx * dx * f\n",
+    "        self.cxy += float(np.sum((x - mxb) * (y - myb))) + dx * dy * f\n",
+    "        self.cyy += float(np.sum((y - myb) ** 2)) + dy * dy * f\n",
+    "        self.mx += dx * nb / n\n",
+    "        self.my += dy * nb / n\n",
+    "        self.n = n\n",
+    "\n",
+    "    def fit(self):\n",
+    "        if self.cxx <= 0.0:\n",
+    "            nan = float('nan')\n",
+    "            return {'m': nan, 'b': nan, 'vmax': nan, 'Km': nan, 'k2': nan, 'rss': nan}\n",
+    "        m = self.cxy / self.cxx\n",
+    "        b = self.my - m * self.mx\n",
+    "        vmax = 1 / b\n",
+    "        return {'m': m, 'b': b, 'vmax': vmax, 'Km': m * vmax, 'k2': vmax / self.E0,\n",
+    "                'rss': self.cyy - m * self.cxy}\n",
+    "\n",
+    "# Stream the pepsin data one point at a time\n",
+    "online = OnlineLineweaverBurk()\n",
+    "for S_i, v_i in zip(S, v):\n",
+    "    online.add(S_i, v_i)\n",
+    "res = online.fit()\n",
+    "print(f\"vmax = {res['vmax']:.4f} mM/s\")\n",
+    "print(f\"Km   = {res['Km']:.4f} mM\")\n",
+    "print(f\"k2   = {res['k2']:.4f} s^-1\")\n",
+    "\n",
+    "# A sliding window of the last 4 points matches a batch fit of the same rows\n",
+    "window = OnlineLineweaverBurk()\n",
+    "window.add_many(S[:4], v[:4])\n",
+    "for i in range(4, len(S)):\n",
+    "    window.add(S[i], v[i])\n",
+    "    window.remove(S[i - 4], v[i - 4])\n",
+    "ref = lineweaver_burk_batch(S[-4:], v[-4:], np.array([0, 4]))\n",
+    "print(f\"window Km = {window.fit()['Km']:.6f} mM, batch Km = {ref['Km'][0]:.6f} mM\")"
+   ]
+  },
+  {
+   "cell_type": "markdown",
+   "id": "99024145-9b34-46ff-b5eb-7654b625e2b0",
+   "metadata": {},
+   "source": [
+    "Latency is measured per call with `time.perf_counter_ns`, on a stream of 10^6 synthetic points kept in a 1,000-point sliding window (one `add`, one `remove` and one `fit` per point). The timer overhead, measured on an empty interval, is subtracted."
+   ]
+  },
+  {
+   "cell_type": "code",
+   "execution_count": 96,
+   "id": "c00c5946-7572-454f-b46a-a295838dac30",
+   "metadata": {},
+   "outputs": [
+    {
+     "name": "stdout",
+     "output_type": "stream",
+     "text": [
+      "add: p50=   513ns p90=  1130ns p99=  1642ns p99.9=  2643ns\n",
+      "     <100 ns |                                                     0.00%\n",
+      "     <200 ns |                                                     0.00%\n",
+      "     <300 ns |                                                     0.00%\n",
+      "     <500 ns | #####################                              43.67%\n",
+      "     <750 ns | ##########                                         20.43%\n",
+      "    <1000 ns | ########                                           17.24%\n",
+      "    <2000 ns | #########                                          18.41%\n",
+      "    <5000 ns |                                                     0.21%\n",
+      "   <10000 ns |                                                     0.01%\n",
+      "  >=10000 ns |                                                     0.03%\n",
+      "remove: p50=   737ns p90=  1477ns p99=  2080ns p99.9=  3278ns\n",
+      "     <100 ns |                                                     0.00%\n",
+      "     <200 ns |                                                     0.00%\n",
+      "     <300 ns |                                                     0.00%\n",
+      "     <500 ns |                                                     0.00%\n",
+      "     <750 ns | ###########################                        54.20%\n",
+      "    <1000 ns | ####                                                9.70%\n",
+      "    <2000 ns | #################                                  34.72%\n",
+      "    <5000 ns |                                                     1.31%\n",
+      "   <10000 ns |                                                     0.02%\n",
+      "  >=10000 ns |                                                     0.04%\n",
+      "fit: p50=   582ns p90=  1050ns p99=  1293ns p99.9=  2408ns\n",
+      "     <100 ns |                                                     0.00%\n",
+      "     <200 ns |                                                     0.00%\n",
+      "     <300 ns |                                                     0.00%\n",
+      "     <500 ns | #                                                   3.20%\n",
+      "     <750 ns | ##############################                     60.97%\n",
+      "    <1000 ns | ###########                                        22.24%\n",
+      "    <2000 ns | ######                                             13.35%\n",
+      "    <5000 ns |                                                     0.20%\n",
+      "   <10000 ns |                                                     0.01%\n",
+      "  >=10000 ns |                                                     0.03%\n",
+      "window Km drift vs batch after 1e6 updates: 6.2e-14 mM\n"
+     ]
+    }
+   ],
+   "source": [
+    "def latency_histogram(samples_ns, edges=(100, 200, 300, 500, 750, 1000, 2000, 5000, 10000)):\n",
+    "    \"\"\"Percentiles and a log-spaced text histogram of per-call latencies.\"\"\"\n",
+    "    lines = [' '.join(f\"p{p:g}={np.percentile(samples_ns, p):6.0f}ns\" for p in (50, 90, 99, 99.9))]\n",
+    "    counts, _ = np.histogram(samples_ns, bins=(0,) + edges + (np.inf,))\n",
+    "    labels = [f\"<{e}\" for e in edges] + [f\">={edges[-1]}\"]\n",
+    "    for label, c in zip(labels, counts):\n",
+    "        lines.append(f\"  {label:>7} ns | {'#' * int(50 * c / len(samples_ns)):<50} {c / len(samples_ns):6.2%}\")\n",
+    "    return '\\n'.join(lines)\n",
+    "\n",
+    "n_stream, width = 1_000_000, 1_000\n",
+    "S_s, v_s, _ = synthetic_plate(n_stream // 7 + 1, seed=4)\n",
+    "S_s, v_s = S_s[:n_stream].tolist(), v_s[:n_stream].tolist()\n",
+    "\n",
+    "clock = time.perf_counter_ns\n",
+    "overhead = np.median([-(clock() - clock()) for _ in range(100_000)])\n",
+    "lat = {'add': np.empty(n_stream), 'remove': np.empty(n_stream), 'fit': np.empty(n_stream)}\n",
+    "online = OnlineLineweaverBurk()\n",
+    "for i in range(n_stream):\n",
+    "    t0 = clock(); online.add(S_s[i], v_s[i]); t1 = clock()\n",
+    "    if i >= width:\n",
+    "        online.remove(S_s[i - width], v_s[i - width])\n",
+    "    t2 = clock(); online.fit(); t3 = clock()\n",
+    "    lat['add'][i], lat['fit'][i] = t1 - t0, t3 - t2\n",
+    "    lat['remove'][i] = t2 - t1\n",
+    "lat['remove'] = lat['remove'][width:]\n",
+    "\n",
+    "for op, samples in lat.items():\n",
+    "    print(f\"{op}: {latency_histogram(samples - overhead)}\")\n",
+    "ref = lineweaver_burk_batch(np.array(S_s[-width:]), np.array(v_s[-width:]), np.array([0, width]))\n",
+    "print(f\"window Km drift vs batch after 1e6 updates: {abs(online.fit()['Km'] - ref['Km'][0]):.1e} mM\")"
+   ]
+  },
+  {
+   "cell_type": "markdown",
+   "id": "ee7e2ba7-5a6c-4dbb-a438-fe75030c037c",
+   "metadata": {},
+   "source": [
+    "The sub-microsecond target for a single update is met only at the median. In this pure-Python implementation `add` and `remove` take about 0.5 and 0.7 \u00b5s at p50, but 1.1 and 1.5 \u00b5s at p90 and up to 2 \u00b5s at p99, mostly interpreter and attribute-access overhead rather than arithmetic. Meeting the target in the tail would need the update compiled, or updates batched through `add_many`."
+   ]
+  },
+  {
+   "cell_type": "markdown",
+   "id": "6b91e8a5-8ea7-4913-8863-8fa0cc301ad8",
+   "metadata": {},
+   "source": [
+    "### Step 9. A library of rate laws and model selection\n",
+    "The Lineweaver-Burk line only describes the plain Michaelis-Menten mechanism. Inhibitor screens and cooperative enzymes need other rate laws, where $[I]$ is the inhibitor concentration:\n",
+    "\n",
+    "| Model | Rate law | Parameters |\n",
+    "| ----- | -------- | ---------- |\n",
+    "| Michaelis-Menten | $v=\\frac{V_{max}[S]}{K_M+[S]}$ | $V_{max},K_M$ |\n",
+    "| Competitive | $v=\\frac{V_{max}[S]}{K_M(1+[I]/K_i)+[S]}$ | $V_{max},K_M,K_i$ |\n",
+    "| Uncompetitive | $v=\\frac{V_{max}[S]}{K_M+[S](1+[I]/K_i')}$ | $V_{max},K_M,K_i'$ |\n",
+    "| Mixed | $v=\\frac{V_{max}[S]}{K_M(1+[I]/K_i)+[S](1+[I]/K_i')}$ | $V_{max},K_M,K_i,K_i'$ |\n",
+    "| Hill | $v=\\frac{V_{max}[S]^h}{K_{0.5}^h+[S]^h}$ | $V_{max},K_{0.5},h$ |\n",
+    "| Substrate inhibition | $v=\\frac{V_{max}[S]}{K_M+[S]+[S]^2/K_{si}}$ | $V_{max},K_M,K_{si}$ |\n",
+    "\n",
+    "Each rate law is a class whose static `rate` and `jacobian` evaluate a whole batch of points with vectorized expressions. The fitter looks the model up once per batch, so no per-point dispatch happens inside the Levenberg-Marquardt loop; it generalises Step 4 to $k$ parameters by reducing the $k(k+1)/2$ products of Jacobian columns per series and solving the stacked $k\\times k$ systems with `np.linalg.solve`. All parameters are constrained to stay positive.\n",
+    "\n",
+    "Candidates are ranked per series with the Akaike and Bayesian information criteria for least squares. With only 7 points in `pepsin.txt` the small-sample correction of the AIC matters, so $AIC_c$ is used:\n",
+    "<p align='center'>\n",
+    "    $$AIC_c=n\\ln\\frac{RSS}{n}+2k+\\frac{2k(k+1)}{n-k-1},\\quad BIC=n\\ln\\frac{RSS}{n}+k\\ln n$$\n",
+    "</p>"
+   ]
+  },
+  {
+   "cell_type": "code",
+   "execution_count": 97,
+   "id": "facb0c03-a35f-4468-8bfb-5fe4cda0593c",
+   "metadata": {},
+   "outputs": [
+    {
+     "name": "stdout",
+     "output_type": "stream",
+     "text": [
+      "MichaelisMenten      AICc  -175.7  BIC  -178.8  vmax = 0.01447, Km = 0.3268\n",
+      "Hill                 AICc  -168.7  BIC  -176.9  vmax = 0.01447, K_half = 0.3268, h = 1\n",
+      "SubstrateInhibition  AICc  -170.9  BIC  -179.1  vmax = 0.01447, Km = 0.327, Ksi = 5.183e+04\n",
+      "selected (AICc): MichaelisMenten\n"
+     ]
+    }
+   ],
+   "source": [
+    "class MichaelisMenten:\n",
+    "    params = ('vmax', 'Km')\n",
+    "\n",
+    "    @staticmethod\n",
+    "    def rate(S, I, p):\n",
+    "        return p[0] * S / (p[1] + S)\n",
+    "\n",
+    "    @staticmethod\n",
+    "    def jacobian(S, I, p):\n",
+    "        d = 1 / (p[1] + S)\n",
+    "        J_v = S * d\n",
+    "        return [J_v, -p[0] * J_v * d]\n",
+    "\n",
+    "class CompetitiveInhibition:\n",
+    "    params = ('vmax', 'Km', 'Ki')\n",
+    "\n",
+    "    @staticmethod\n",
+    "    def rate(S, I, p):\n",
+    "        return p[0] * S / (p[1] * (1 + I / p[2]) + S)\n",
+    "\n",
+    "    @staticmethod\n",
+    "    def jacobian(S, I, p):\n",
+    "        a = 1 + I / p[2]\n",
+    "        d = 1 / (p[1] * a + S)\n",
+    "        J_v = S * d\n",
+    "        g = p[0] * J_v * d\n",
+    "        return [J_v, -g * a, g * p[1] * I / p[2]**2]\n",
+    "\n",
+    "class UncompetitiveInhibition:\n",
+    "    params = ('vmax', 'Km', 'Ki_prime')\n",
+    "\n",
+    "    @staticmethod\n",
+    "    def rate(S, I, p):\n",
+    "        return p[0] * S / (p[1] + S * (1 + I / p[2]))\n",
+    "\n",
+    "    @staticmethod\n",
+    "    def jacobian(S, I, p):\n",
+    "        d = 1 / (p[1] + S * (1 + I / p[2]))\n",
+    "        J_v = S * d\n",
+    "        g = p[0] * J_v * d\n",
+    "        return [J_v, -g, g * S * I / p[2]**2]\n",
+    "\n",
+    "class MixedInhibition:\n",
+    "    params = ('vmax', 'Km', 'Ki', 'Ki_prime')\n",
+    "\n",
+    "    @staticmethod\n",
+    "    def rate(S, I, p):\n",
+    "        return p[0] * S / (p[1] * (1 + I / p[2]) + S * (1 + I / p[3]))\n",
+    "\n",
+    "    @staticmethod\n",
+    "    def jacobian(S, I, p):\n",
+    "        a = 1 + I / p[2]\n",
+    "        d = 1 / (p[1] * a + S * (1 + I / p[3]))\n",
+    "        J_v = S * d\n",
+    "        g = p[0] * J_v * d\n",
+    "        return [J_v, -g * a, g * p[1] * I / p[2]**2, g * S * I / p[3]**2]\n",
+    "\n",
+    "class Hill:\n",
+    "    params = ('vmax', 'K_half', 'h')\n",
+    "\n",
+    "    @staticmethod\n",
+    "    def rate(S, I, p):\n",
+    "        return p[0] / (1 + (p[1] / S) ** p[2])\n",
+    "\n",
+    "    @staticmethod\n",
+    "    def jacobian(S, I, p):\n",
+    "        u = (p[1] / S) ** p[2]\n",
+    "        J_v = 1 / (1 + u)\n",
+    "        g = p[0] * J_v * J_v * u\n",
+    "        return [J_v, -g * p[2] / p[1], -g * np.log(p[1] / S)]\n",
+    "\n",
+    "class SubstrateInhibition:\n",
+    "    params = ('vmax', 'Km', 'Ksi')\n",
+    "\n",
+    "    @staticmethod\n",
+    "    def rate(S, I, p):\n",
+    "        return p[0] * S / (p[1] + S + S * S / p[2])\n",
+    "\n",
+    "    @staticmethod\n",
+    "    def jacobian(S, I, p):\n",
+    "        d = 1 / (p[1] + S + S * S / p[2])\n",
+    "        J_v = S * d\n",
+    "        g = p[0] * J_v * d\n",
+    "        return [J_v, -g, g * S * S / p[2]**2]\n",
+    "\n",
+    "RATE_LAWS = (MichaelisMenten, CompetitiveInhibition, UncompetitiveInhibition,\n",
+    "             MixedInhibition, Hill, SubstrateInhibition)\n",
+    "\n",
+    "def rate_law_initial_guess(model, S, I, v, offsets):\n",
+    "    \"\"\"Lineweaver-Burk vmax/Km plus neutral starting values for the extra parameters.\"\"\"\n",
+    "    vmax0, Km0 = mm_initial_guess(S, v, offsets)\n",
+    "    starts = offsets[:-1]\n",
+    "    extra = {'Ki': np.maximum.reduceat(I, starts), 'Ki_prime': np.maximum.reduceat(I, starts),\n",
+    "             'K_half': Km0, 'h': np.ones_like(Km0), 'Ksi': 10 * np.maximum.reduceat(S, starts)}\n",
+    "    p0 = [vmax0, Km0] + [extra[name] for name in model.params[2:]]\n",
+    "    p0 = np.array(p0)\n",
+    "    p0[~np.isfinite(p0) | (p0 <= 0)] = 1.0\n",
+    "    return p0\n",
+    "\n",
+    "def series_rows(offsets, idx):\n",
+    "    \"\"\"Row indices and rebased offsets of the series idx of a batch.\"\"\"\n",
+    "    lengths = np.diff(offsets)[idx]\n",
+    "    sub = np.concatenate([[0], np.cumsum(lengths)])\n",
+    "    rows = np.arange(sub[-1]) + np.repeat(offsets[idx] - sub[:-1], lengths)\n",
+    "    return rows, sub\n",
+    "\n",
+    "def rate_law_lm_batch(model, S, I, v, offsets, p0=None, max_iter=200, tol=1e-10):\n",
+    "    \"\"\"Levenberg-Marquardt fit of one rate law to every series of a batch.\n",
+    "\n",
+    "    Converged series are dropped from the working set whenever half of it has\n",
+    "    finished, so slow series do not keep the whole batch iterating.\"\"\"\n",
+    "    rate, jacobian = model.rate, model.jacobian\n",
+    "    k = len(model.params)\n",
+    "    n_series = len(offsets) - 1\n",
+    "    p = rate_law_initial_guess(model, S, I, v, offsets) if p0 is None else np.array(p0, dtype=float)\n",
+    "    pairs = [(i, j) for i in range(k) for j in range(i, k)]\n",
+    "    lam = np.full(n_series, 1e-3)\n",
+    "    rss = np.empty(n_series)\n",
+    "    iterations = np.zeros(n_series, dtype=int)\n",
+    "    work = np.arange(n_series)\n",
+    "    with np.errstate(all='ignore'):\n",
+    "        while work.size:\n",
+    "            rows, off_w = series_rows(offsets, work)\n",
+    "            S_w, I_w, v_w = S[rows], I[rows], v[rows]\n",
+    "            starts = off_w[:-1]\n",
+    "            seg = np.repeat(np.arange(work.size), np.diff(off_w))\n",
+    "            p_w, lam_w, it_w = p[:, work], lam[work], iterations[work]\n",
+    "            r = v_w - rate(S_w, I_w, p_w[:, seg])\n",
+    "            rss_w = np.add.reduceat(r * r, starts)\n",
+    "            active = it_w < max_iter\n",
+    "            A = np.empty((work.size, k, k))\n",
+    "            g = np.empty((work.size, k))\n",
+    "            while np.count_nonzero(active) > work.size // 2:\n",
+    "                J = jacobian(S_w, I_w, p_w[:, seg])\n",
+    "                for i, j in pairs:\n",
+    "                    A[:, i, j] = A[:, j, i] = np.add.reduceat(J[i] * J[j], starts)\n",
+    "                for i in range(k):\n",
+    "                    g[:, i] = np.add.reduceat(J[i] * r, starts)\n",
+    "                # Marquardt scaling; the tiny shift keeps unidentifiable parameters solvable\n",
+    "                diag = np.einsum('nii->ni', A)\n",
+    "                diag *= 1 + lam_w[:, None]\n",
+    "                diag += np.finfo(float).tiny\n",
+    "                step = np.linalg.solve(A, g[:, :, None])[:, :, 0].T\n",
+    "                p_t = p_w + np.where(active, step, 0)\n",
+    "                r_t = v_w - rate(S_w, I_w, p_t[:, seg])\n",
+    "                rss_t = np.add.reduceat(r_t * r_t, starts)\n",
+    "\n",
+    "                better = active & np.all(p_t > 0, axis=0) & (rss_t < rss_w)\n",
+    "                converged = better & (rss_w - rss_t <= tol * rss_w)\n",
+    "                p_w = np.where(better, p_t, p_w)\n",
+    "                r = np.where(better[seg], r_t, r)\n",
+    "                rss_w = np.where(better, rss_t, rss_w)\n",
+    "                lam_w = np.where(better, lam_w / 10, lam_w * 10)\n",
+    "                it_w += active\n",
+    "                active &= ~converged & (lam_w < 1e10) & (it_w < max_iter)\n",
+    "            p[:, work], lam[work], rss[work], iterations[work] = p_w, lam_w, rss_w, it_w\n",
+    "            work = work[active]\n",
+    "    out = dict(zip(model.params, p))\n",
+    "    out.update(rss=rss, iterations=iterations)\n",
+    "    return out\n",
+    "\n",
+    "def select_rate_law(S, I, v, offsets, models=RATE_LAWS):\n",
+    "    \"\"\"Fit every candidate and rank them per series by AICc and BIC.\"\"\"\n",
+    "    n = np.diff(offsets)\n",
+    "    fits, aic, bic = {}, [], []\n",
+    "    for model in models:\n",
+    "        fit = rate_law_lm_batch(model, S, I, v, offsets)\n",
+    "        k = len(model.params)\n",
+    "        ll = n * np.log(fit['rss'] / n)\n",
+    "        fits[model.__name__] = fit\n",
+    "        with np.errstate(divide='ignore'):\n",
+    "            aic.append(np.where(n > k + 1, ll + 2 * k + 2 * k * (k + 1) / (n - k - 1), np.inf))\n",
+    "        bic.append(ll + k * np.log(n))\n",
+    "    names = np.array([m.__name__ for m in models])\n",
+    "    aic, bic = np.array(aic), np.array(bic)\n",
+    "    return {'fits': fits, 'aic': aic, 'bic': bic,\n",
+    "            'best_aic': names[np.argmin(aic, axis=0)], 'best_bic': names[np.argmin(bic, axis=0)]}\n",
+    "\n",
+    "# Pepsin has no inhibitor: compare the substrate-only rate laws\n",
+    "I0 = np.zeros_like(S)\n",
+    "sel = select_rate_law(S, I0, v, np.array([0, len(S)]), models=(MichaelisMenten, Hill, SubstrateInhibition))\n",
+    "for (name, fit_m), a, b in zip(sel['fits'].items(), sel['aic'][:, 0], sel['bic'][:, 0]):\n",
+    "    values = ', '.join(f\"{p} = {fit_m[p][0]:.4g}\" for p in fit_m if p not in ('rss', 'iterations'))\n",
+    "    print(f\"{name:<20} AICc {a:7.1f}  BIC {b:7.1f}  {values}\")\n",
+    "print('selected (AICc):', sel['best_aic'][0])"
+   ]
+  },
+  {
+   "cell_type": "markdown",
+   "id": "257d09f2-076c-4ba1-9e85-51720bc52f7b",
+   "metadata": {},
+   "source": [
+    "The benchmark simulates an inhibitor screen: every series is a grid of 8 substrate and 4 inhibitor concentrations generated from a randomly chosen rate law with 3% noise. It reports fit throughput per model and how often $AIC_c$ recovers the generating model."
+   ]
+  },
+  {
+   "cell_type": "code",
+   "execution_count": 98,
+   "id": "933ab823-1860-45ba-bcf4-eb2eb594efa2",
+   "metadata": {},
+   "outputs": [
+    {
+     "name": "stdout",
+     "output_type": "stream",
+     "text": [
+      "model                        fits/s  median iter\n",
+      "MichaelisMenten              39,129            4\n",
+      "CompetitiveInhibition         9,274           18\n",
+      "UncompetitiveInhibition      11,529           11\n",
+      "MixedInhibition               5,528           17\n",
+      "Hill                         11,094            4\n",
+      "SubstrateInhibition          13,742           11\n",
+      "generated by MichaelisMenten          AICc picks it  68.4%\n",
+      "generated by CompetitiveInhibition    AICc picks it  87.4%\n",
+      "generated by UncompetitiveInhibition  AICc picks it  97.8%\n",
+      "generated by MixedInhibition          AICc picks it 100.0%\n",
+      "generated by Hill                     AICc picks it 100.0%\n",
+      "generated by SubstrateInhibition      AICc picks it 100.0%\n"
+     ]
+    }
+   ],
+   "source": [
+    "def synthetic_screen(n_series, seed=5, noise=0.03):\n",
+    "    \"\"\"Series of 8 [S] x 4 [I] points, each generated by a random rate law.\"\"\"\n",
+    "    rng = np.random.default_rng(seed)\n",
+    "    S_grid, I_grid = np.meshgrid(np.geomspace(0.05, 20.0, 8), np.array([0.0, 0.5, 1.0, 2.0]))\n",
+    "    S_grid, I_grid = S_grid.ravel(), I_grid.ravel()\n",
+    "    n_points = S_grid.size\n",
+    "    truth = rng.integers(0, len(RATE_LAWS), n_series)\n",
+    "    S = np.tile(S_grid, n_series)\n",
+    "    I = np.tile(I_grid, n_series)\n",
+    "    v = np.empty_like(S)\n",
+    "    true_params = {'vmax': 0.0145, 'Km': 0.3267, 'Ki': 0.8, 'Ki_prime': 1.2, 'K_half': 0.5, 'h': 2.0, 'Ksi': 4.0}\n",
+    "    for m, model in enumerate(RATE_LAWS):\n",
+    "        rows = np.flatnonzero(np.repeat(truth == m, n_points))\n",
+    "        p = np.array([true_params[name] * rng.uniform(0.7, 1.3, rows.size // n_points).repeat(n_points)\n",
+    "                      for name in model.params])\n",
+    "        v[rows] = model.rate(S[rows], I[rows], p)\n",
+    "    v *= 1 + noise * rng.standard_normal(v.size)\n",
+    "    return S, I, v, np.arange(n_series + 1) * n_points, truth\n",
+    "\n",
+    "n_series = 20_000\n",
+    "S_q, I_q, v_q, off_q, truth = synthetic_screen(n_series)\n",
+    "print(f\"{'model':<24} {'fits/s':>10} {'median iter':>12}\")\n",
+    "for model in RATE_LAWS:\n",
+    "    t0 = time.perf_counter()\n",
+    "    fit_q = rate_law_lm_batch(model, S_q, I_q, v_q, off_q)\n",
+    "    dt = time.perf_counter() - t0\n",
+    "    print(f\"{model.__name__:<24} {n_series / dt:10,.0f} {np.median(fit_q['iterations']):12.0f}\")\n",
+    "\n",
+    "sel = select_rate_law(S_q, I_q, v_q, off_q)\n",
+    "names = np.array([m.__name__ for m in RATE_LAWS])\n",
+    "for m, name in enumerate(names):\n",
+    "    print(f\"generated by {name:<24} AICc picks it {np.mean(sel['best_aic'][truth == m] == name):6.1%}\")"
+   ]
+  },
+  {
+   "cell_type": "markdown",
+   "id": "5cc999a6-0e7a-45be-9fd0-0869c3706854",
+   "metadata": {},
+   "source": [
+    "### Step 10. Simulating the full mechanism $E + S \\rightleftharpoons ES \\rightarrow P + E$\n",
+    "$k_2 = v_{max}/[E]_0$ relies on the quasi-steady-state assumption (QSSA) that $[ES]$ adjusts instantly to $[S]$. This holds when $[E]_0$ is small compared with $[S]_0 + K_M$ (Segel's criterion $\\varepsilon=[E]_0/([S]_0+K_M)\\ll 1$). With $[E]_0 = 0.028\\;mM$ and $[S]$ as low as $0.1\\;mM$, that is not obviously true, so we integrate the mass-action equations. Conservation of enzyme and substrate, $[E]=[E]_0-[ES]$ and $[P]=[S]_0-[S]-[ES]$, leaves two equations:\n",
+    "<p align='center'>\n",
+    "    $$\\frac{d[S]}{dt}=-k_1[E][S]+k_{-1}[ES],\\quad \\frac{d[ES]}{dt}=k_1[E][S]-(k_{-1}+k_2)[ES]$$\n",
+    "</p>\n",
+    "Binding is often orders of magnitude faster than turnover, which makes the system stiff. We use the linearly implicit Rosenbrock method of Shampine and Reichelt (the scheme behind MATLAB's `ode23s`). Each step solves three $2\\times 2$ systems with $W = I - h\\,d\\,J$, $d = 1/(2+\\sqrt{2})$, using the analytic Jacobian $J$. An embedded third-order error estimate drives the adaptive step size. The method is L-stable, so the step size follows the slow turnover rather than the fast binding.\n",
+    "\n",
+    "Every trajectory of a batch carries its own time and step size, and all of them advance together in vectorized form. Steps are clipped to land exactly on the requested output times. Results are written to an array of shape `(4, N, T)` (species $E$, $S$, $ES$, $P$). The time course of one species of one parameter set is then contiguous in memory. Large sweeps are cut into chunks that run on the work-stealing pool of Step 4."
+   ]
+  },
+  {
+   "cell_type": "code",
+   "execution_count": 99,
+   "id": "a3d1a3d1-570e-4d32-a5f1-186d4b9a17b4",
+   "metadata": {},
+   "outputs": [
+    {
+     "name": "stdout",
+     "output_type": "stream",
+     "text": [
+      "k1 = 4.642 mM^-1 s^-1, k-1 = 1.0 s^-1, k2 = 0.5166 s^-1\n",
+      " [S]0/mM   eps    v(5 s) ODE   v(5 s) QSSA   rel. error  steps\n",
+      "    0.1   0.066      0.00290       0.00286       1.45%    142\n",
+      "    0.2   0.053      0.00493       0.00489       0.82%    146\n",
+      "    0.5   0.034      0.00835       0.00833       0.22%    150\n",
+      "    1.0   0.021      0.01070       0.01070       0.05%    150\n",
+      "    5.0   0.005      0.01356       0.01356       0.00%    147\n",
+      "   10.0   0.003      0.01400       0.01400       0.00%    148\n",
+      "   20.0   0.001      0.01423       0.01423       0.00%    148\n"
+     ]
+    }
+   ],
+   "source": [
+    "SPECIES = ('E', 'S', 'ES', 'P')\n",
+    "\n",
+    "def simulate_mechanism(k1, km1, k2, E0, S0, t_out, rtol=1e-6, atol=1e-12, max_steps=100_000):\n",
+    "    \"\"\"Integrate E + S <-> ES -> P + E for a batch of parameter sets.\n",
+    "\n",
+    "    All arguments except t_out broadcast to a common shape (N,); t_out starts at 0.\n",
+    "    Returns the trajectories, shape (4, N, len(t_out)), and the accepted steps per set.\"\"\"\n",
+    "    k1, km1, k2, E0, S0 = (np.ravel(a).astype(float) for a in np.broadcast_arrays(k1, km1, k2, E0, S0))\n",
+    "    n, T = k1.size, len(t_out)\n",
+    "    out = np.empty((4, n, T))\n",
+    "    d = 1 / (2 + np.sqrt(2))\n",
+    "    e32 = 6 + np.sqrt(2)\n",
+    "\n",
+    "    def rhs(S, ES):\n",
+    "        bind = k1 * (E0 - ES) * S\n",
+    "        return -bind + km1 * ES, bind - (km1 + k2) * ES\n",
+    "\n",
+    "    def solve_W(h, S, ES, b0, b1):\n",
+    "        # (I - h d J) z = b with the analytic Jacobian of rhs\n",
+    "        hd = h * d\n",
+    "        j00, j01 = -k1 * (E0 - ES), k1 * S + km1\n",
+    "        j10, j11 = -j00, -j01 - k2\n",
+    "        a00, a01, a10, a11 = 1 - hd * j00, -hd * j01, -hd * j10, 1 - hd * j11\n",
+    "        det = a00 * a11 - a01 * a10\n",
+    "        return (a11 * b0 - a01 * b1) / det, (a00 * b1 - a10 * b0) / det\n",
+    "\n",
+    "    t = np.zeros(n)\n",
+    "    S, ES = S0.copy(), np.zeros(n)\n",
+    "    h = np.minimum(t_out[-1], 0.01 / (k1 * (S0 + E0) + km1 + k2))\n",
+    "    nxt = np.ones(n, dtype=int)\n",
+    "    steps = np.zeros(n, dtype=int)\n",
+    "    out[:, :, 0] = [E0, S0, 0 * S0, 0 * S0]\n",
+    "    active = np.full(n, T > 1)\n",
+    "    for _ in range(max_steps):\n",
+    "        if not active.any():\n",
+    "            break\n",
+    "        remaining = t_out[np.minimum(nxt, T - 1)] - t\n",
+    "        h_eff = np.where(active, np.minimum(h, remaining), 0)\n",
+    "\n",
+    "        F0 = rhs(S, ES)\n",
+    "        k1_ = solve_W(h_eff, S, ES, *F0)\n",
+    "        F1 = rhs(S + 0.5 * h_eff * k1_[0], ES + 0.5 * h_eff * k1_[1])\n",
+    "        z = solve_W(h_eff, S, ES, F1[0] - k1_[0], F1[1] - k1_[1])\n",
+    "        k2_ = (z[0] + k1_[0], z[1] + k1_[1])\n",
+    "        S_new, ES_new = S + h_eff * k2_[0], ES + h_eff * k2_[1]\n",
+    "        F2 = rhs(S_new, ES_new)\n",
+    "        k3_ = solve_W(h_eff, S, ES,\n",
+    "                      F2[0] - e32 * (k2_[0] - F1[0]) - 2 * (k1_[0] - F0[0]),\n",
+    "                      F2[1] - e32 * (k2_[1] - F1[1]) - 2 * (k1_[1] - F0[1]))\n",
+    "\n",
+    "        # Embedded error estimate and step-size control\n",
+    "        err = np.maximum(\n",
+    "            np.abs(h_eff / 6 * (k1_[0] - 2 * k2_[0] + k3_[0])) / (atol + rtol * np.maximum(np.abs(S), np.abs(S_new))),\n",
+    "            np.abs(h_eff / 6 * (k1_[1] - 2 * k2_[1] + k3_[1])) / (atol + rtol * np.maximum(np.abs(ES), np.abs(ES_new))))\n",
+    "        accept = active & (err <= 1)\n",
+    "        h = np.where(active, h_eff * np.clip(0.9 * np.maximum(err, 1e-10) ** (-1 / 3), 0.2, 5.0), h)\n",
+    "        t = np.where(accept, t + h_eff, t)\n",
+    "        S = np.where(accept, S_new, S)\n",
+    "        ES = np.where(accept, ES_new, ES)\n",
+    "        steps += accept\n",
+    "\n",
+    "        hit = np.flatnonzero(accept & (h_eff == remaining))\n",
+    "        if hit.size:\n",
+    "            j = nxt[hit]\n",
+    "            out[0, hit, j] = E0[hit] - ES[hit]\n",
+    "            out[1, hit, j] = S[hit]\n",
+    "            out[2, hit, j] = ES[hit]\n",
+    "            out[3, hit, j] = S0[hit] - S[hit] - ES[hit]\n",
+    "            t[hit] = t_out[j]\n",
+    "            nxt[hit] += 1\n",
+    "            active[hit[nxt[hit] == T]] = False\n",
+    "    if active.any():\n",
+    "        raise RuntimeError(f\"{np.count_nonzero(active)} trajectories did not finish in {max_steps} steps\")\n",
+    "    return out, steps\n",
+    "\n",
+    "def simulate_sweep(t_out, n_threads=None, chunk=512, **grid):\n",
+    "    \"\"\"Simulate the outer product of the k1, km1, k2, E0 and S0 values in grid.\"\"\"\n",
+    "    names = ('k1', 'km1', 'k2', 'E0', 'S0')\n",
+    "    axes = np.meshgrid(*(np.atleast_1d(grid[k]) for k in names), indexing='ij')\n",
+    "    params = {k: a.ravel() for k, a in zip(names, axes)}\n",
+    "    n = axes[0].size\n",
+    "    out = np.empty((4, n, len(t_out)))\n",
+    "\n",
+    "    def run(j0):\n",
+    "        j1 = min(j0 + chunk, n)\n",
+    "        out[:, j0:j1], _ = simulate_mechanism(*(params[k][j0:j1] for k in names), t_out)\n",
+    "\n",
+    "    WorkStealingPool(n_threads).map(run, range(0, n, chunk))\n",
+    "    return params, out\n",
+    "\n",
+    "# Pepsin parameters: k2 from Step 2 and k1 chosen so that (k-1 + k2)/k1 = Km for k-1 = 1 s^-1\n",
+    "k2_p, Km_p, km1_p = 0.5166, 0.3267, 1.0\n",
+    "k1_p = (km1_p + k2_p) / Km_p\n",
+    "t_pep = np.linspace(0, 5, 6)\n",
+    "traj, steps = simulate_mechanism(k1_p, km1_p, k2_p, 0.028, S, t_pep)\n",
+    "v_sim = k2_p * traj[2, :, -1]\n",
+    "v_mm = k2_p * 0.028 * traj[1, :, -1] / (Km_p + traj[1, :, -1])\n",
+    "print(f\"k1 = {k1_p:.3f} mM^-1 s^-1, k-1 = {km1_p} s^-1, k2 = {k2_p} s^-1\")\n",
+    "print(\" [S]0/mM   eps    v(5 s) ODE   v(5 s) QSSA   rel. error  steps\")\n",
+    "for i in range(len(S)):\n",
+    "    eps = 0.028 / (S[i] + Km_p)\n",
+    "    print(f\"{S[i]:7.1f} {eps:7.3f} {v_sim[i]:12.5f} {v_mm[i]:13.5f} {v_sim[i] / v_mm[i] - 1:11.2%} {steps[i]:6d}\")"
+   ]
+  },
+  {
+   "cell_type": "markdown",
+   "id": "ad74f728-141a-4965-96b7-307930bd70f3",
+   "metadata": {},
+   "source": [
+    "A sweep over $5^5$ parameter sets shows where the QSSA breaks down. For each trajectory we compare the simulated rate $k_2[ES](t)$ with the Michaelis-Menten rate $k_2[E]_0[S](t)/(K_M+[S](t))$ after the initial binding transient ($t > 5/(k_1([S]_0+[E]_0)+k_{-1}+k_2)$), and group the largest relative deviation by $\\varepsilon$. Since $\\varepsilon$ is evaluated at $[S]_0$, the worst cases even at small $\\varepsilon$ come from the end of the reaction, when $[S](t)$ has fallen below $[E]_0$."
+   ]
+  },
+  {
+   "cell_type": "code",
+   "execution_count": 100,
+   "id": "fcc6842e-6b77-4880-bd4b-376caa7a997c",
+   "metadata": {},
+   "outputs": [
+    {
+     "name": "stdout",
+     "output_type": "stream",
+     "text": [
+      "3125 trajectories x 61 time points in 4.43 s (706 trajectories/s)\n",
+      "    eps range        n   median dev   max dev\n",
+      "[ 0.00,  0.01)    1276        0.32%     1.62%\n",
+      "[ 0.01,  0.03)     523        0.63%    54.58%\n",
+      "[ 0.03,  0.10)     519        1.44%    20.77%\n",
+      "[ 0.10,  0.30)     378        4.91%    51.11%\n",
+      "[ 0.30,  1.00)     241       10.04%    73.19%\n",
+      "[ 1.00,   inf)     188       57.84%   455.74%\n"
+     ]
+    }
+   ],
+   "source": [
+    "t_sweep = np.concatenate([[0], np.geomspace(1e-3, 300, 60)])\n",
+    "grid = dict(k1=np.geomspace(1, 1e4, 5), km1=np.geomspace(0.1, 100, 5), k2=np.geomspace(0.05, 50, 5),\n",
+    "            E0=np.geomspace(0.0028, 0.28, 5), S0=np.geomspace(0.05, 5, 5))\n",
+    "t0 = time.perf_counter()\n",
+    "params, traj = simulate_sweep(t_sweep, **grid)\n",
+    "dt = time.perf_counter() - t0\n",
+    "n_traj = traj.shape[1]\n",
+    "print(f\"{n_traj} trajectories x {len(t_sweep)} time points in {dt:.2f} s ({n_traj / dt:,.0f} trajectories/s)\")\n",
+    "\n",
+    "Km_s = (params['km1'] + params['k2']) / params['k1']\n",
+    "eps = params['E0'] / (params['S0'] + Km_s)\n",
+    "v_ode = params['k2'][:, None] * traj[2]\n",
+    "v_qssa = params['k2'][:, None] * params['E0'][:, None] * traj[1] / (Km_s[:, None] + traj[1])\n",
+    "t_fast = 5 / (params['k1'] * (params['S0'] + params['E0']) + params['km1'] + params['k2'])\n",
+    "late = t_sweep[None, :] > t_fast[:, None]\n",
+    "dev = np.where(late, np.abs(v_ode - v_qssa), 0).max(axis=1) / v_ode.max(axis=1)\n",
+    "bins = [0, 0.01, 0.03, 0.1, 0.3, 1, np.inf]\n",
+    "print(\"    eps range        n   median dev   max dev\")\n",
+    "for lo, hi in zip(bins[:-1], bins[1:]):\n",
+    "    sel_eps = (eps >= lo) & (eps < hi)\n",
+    "    if sel_eps.any():\n",
+    "        print(f\"[{lo:5.2f}, {hi:5.2f})  {sel_eps.sum():6d} {np.median(dev[sel_eps]):12.2%} {dev[sel_eps].max():9.2%}\")"
+   ]
+  },
+  {
+   "cell_type": "markdown",
+   "id": "2bffc999-41ba-4c59-83f8-5400a5b1549e",
+   "metadata": {},
+   "source": [
+    "Progress curves measured at high enzyme concentration carry information about binding as well as turnover, so $k_1$, $k_{-1}$ and $k_2$ can be estimated directly. `fit_progress_curves` fits all curves at once with shared rate constants. It uses Levenberg-Marquardt in $\\ln k$ (which keeps the constants positive). The Jacobian is a forward difference, and the base point and the three perturbed parameter sets for all curves are simulated as a single batch."
+   ]
+  },
+  {
+   "cell_type": "code",
+   "execution_count": 101,
+   "id": "11adb5a4-52d4-4aa8-a708-9959db8f4b60",
+   "metadata": {},
+   "outputs": [
+    {
+     "name": "stdout",
+     "output_type": "stream",
+     "text": [
+      "k1   true  4.6422  fitted  4.3213  (+/- 6.9%)\n",
+      "km1  true  1.0000  fitted  0.8962  (+/- 10.7%)\n",
+      "k2   true  0.5166  fitted  0.5187  (+/- 0.3%)\n",
+      "10 iterations in 15.73 s\n"
+     ]
+    }
+   ],
+   "source": [
+    "def fit_progress_curves(t_obs, P_obs, E0, S0, k0, max_iter=50, tol=1e-10, rel_step=1e-6):\n",
+    "    \"\"\"Global fit of (k1, k-1, k2) to product curves P_obs of shape (n_curves, len(t_obs)).\"\"\"\n",
+    "    n_curves = len(S0)\n",
+    "    theta = np.log(np.asarray(k0, dtype=float))\n",
+    "    E0 = np.broadcast_to(E0, (n_curves,))\n",
+    "\n",
+    "    def simulate(thetas):\n",
+    "        k = np.exp(thetas)                                  # (m, 3) parameter sets\n",
+    "        m = k.shape[0]\n",
+    "        P, _ = simulate_mechanism(np.repeat(k[:, 0], n_curves), np.repeat(k[:, 1], n_curves),\n",
+    "                                  np.repeat(k[:, 2], n_curves), np.tile(E0, m), np.tile(S0, m), t_obs,\n",
+    "                                  rtol=1e-8)\n",
+    "        return (P[3].reshape(m, n_curves, -1) - P_obs).reshape(m, -1)\n",
+    "\n",
+    "    lam = 1e-3\n",
+    "    r = simulate(theta[None])[0]\n",
+    "    rss = r @ r\n",
+    "    for it in range(max_iter):\n",
+    "        h = rel_step * np.maximum(np.abs(theta), 1)\n",
+    "        res = simulate(np.vstack([theta, theta + np.diag(h)]))\n",
+    "        J = ((res[1:] - res[0]) / h[:, None]).T\n",
+    "        A, g = J.T @ J, -J.T @ res[0]\n",
+    "        while lam < 1e10:\n",
+    "            step = np.linalg.solve(A + lam * np.diag(np.diag(A)), g)\n",
+    "            r_t = simulate((theta + step)[None])[0]\n",
+    "            if r_t @ r_t < rss:\n",
+    "                break\n",
+    "            lam *= 10\n",
+    "        else:\n",
+    "            break\n",
+    "        done = rss - r_t @ r_t <= tol * rss\n",
+    "        theta, rss, lam = theta + step, r_t @ r_t, lam / 10\n",
+    "        if done:\n",
+    "            break\n",
+    "    cov = np.linalg.inv(A) * rss / max(r.size - 3, 1)\n",
+    "    return {'k1': np.exp(theta[0]), 'km1': np.exp(theta[1]), 'k2': np.exp(theta[2]),\n",
+    "            'rel_se': np.sqrt(np.diag(cov)), 'rss': rss, 'iterations': it + 1}\n",
+    "\n",
+    "# Synthetic pepsin progress curves at high enzyme load with 0.5% noise\n",
+    "t_obs = np.concatenate([[0], np.geomspace(0.05, 200, 40)])\n",
+    "S0_obs = np.array([0.05, 0.1, 0.2, 0.5, 1.0])\n",
+    "E0_obs = 0.028\n",
+    "P_true, _ = simulate_mechanism(k1_p, km1_p, k2_p, E0_obs, S0_obs, t_obs, rtol=1e-8)\n",
+    "rng = np.random.default_rng(8)\n",
+    "P_obs = P_true[3] * (1 + 0.005 * rng.standard_normal(P_true[3].shape))\n",
+    "\n",
+    "t0 = time.perf_counter()\n",
+    "pc = fit_progress_curves(t_obs, P_obs, E0_obs, S0_obs, k0=[2 * k1_p, 0.5 * km1_p, 1.5 * k2_p])\n",
+    "dt = time.perf_counter() - t0\n",
+    "for name, true in (('k1', k1_p), ('km1', km1_p), ('k2', k2_p)):\n",
+    "    i = ('k1', 'km1', 'k2').index(name)\n",
+    "    print(f\"{name:<4} true {true:7.4f}  fitted {pc[name]:7.4f}  (+/- {pc['rel_se'][i]:.1%})\")\n",
+    "print(f\"{pc['iterations']} iterations in {dt:.2f} s\")"
+   ]
+  },
+  {
+   "cell_type": "markdown",
+   "id": "1e61a711-be6a-4652-a837-cb1ba549cdff",
+   "metadata": {},
+   "source": [
+    "### Step 11. A lightweight plot renderer for reports\n",
+    "`plt.savefig` writes every glyph of every label as an SVG path, which is why `Plotted as a function of enzymatic kinetics.svg` and `Linearweaver-Burk Plot for pepsin.svg` run to 700-1,300 lines. At around 100 ms per figure, a report of 10,000 series takes hours. The Lineweaver-Burk plot needs very little: `+` markers for the data, the 100-point `x_fit` line, ticks, axis labels, a title and a legend. The renderer below draws exactly that:\n",
+    "\n",
+    "- **SVG**: text stays as `<text>` elements, styles live in one `<style>` block, and the `+` marker is a single `<symbol>` placed with `<use>`. A report with many plots shares one copy of those definitions, so each extra plot adds only its coordinates.\n",
+    "- **PNG**: a NumPy raster with a built-in 5x8 bitmap font, encoded with `zlib`. Series are rendered in parallel on the work-stealing pool, because `zlib` and NumPy release the GIL.\n",
+    "\n",
+    "Both back ends use the same layout (a 600x400 px canvas, like `figsize=(6, 4)` at 100 dpi). Non-finite points are left out before the axis limits are computed, so a series whose fit failed (equal $[S]$ values, a single point, a NaN rate) is drawn with its data only instead of aborting a whole report."
+   ]
+  },
+  {
+   "cell_type": "code",
+   "execution_count": 102,
+   "id": "8712e0f3-7844-46e4-a9ad-53214fc5284a",
+   "metadata": {},
+   "outputs": [
+    {
+     "name": "stdout",
+     "output_type": "stream",
+     "text": [
+      "matplotlib SVG (committed):  33584 bytes\n",
+      "native SVG                :   2917 bytes\n",
+      "native PNG                :   4708 bytes\n",
+      "degenerate series         : fit finite = False, SVG 1546 bytes, PNG 3528 bytes\n"
+     ]
+    }
+   ],
+   "source": [
+    "import zlib\n",
+    "\n",
+    "PLOT_W, PLOT_H = 600, 400\n",
+    "PLOT_BOX = (70, 40, 580, 345)                  # left, top, right, bottom of the axes in px\n",
+    "\n",
+    "def nice_ticks(lo, hi, n=5):\n",
+    "    \"\"\"Round tick positions covering [lo, hi]; none for non-finite limits.\"\"\"\n",
+    "    if not (np.isfinite(lo) and np.isfinite(hi)):\n",
+    "        return np.array([])\n",
+    "    span = hi - lo if hi > lo else abs(hi) or 1.0\n",
+    "    raw = span / n\n",
+    "    step = 10 ** np.floor(np.log10(raw))\n",
+    "    step *= next(f for f in (1, 2, 2.5, 5, 10) if f * step >= raw)\n",
+    "    return np.arange(np.ceil(lo / step) * step, hi + 0.5 * step, step) + 0.0   # no '-0' labels\n",
+    "\n",
+    "def finite_points(x, y):\n",
+    "    \"\"\"The (x, y) pairs where both coordinates are finite.\"\"\"\n",
+    "    x, y = np.asarray(x, dtype=float), np.asarray(y, dtype=float)\n",
+    "    keep = np.isfinite(x) & np.isfinite(y)\n",
+    "    return x[keep], y[keep]\n",
+    "\n",
+    "def plot_layout(x, y, x_fit, y_fit):\n",
+    "    \"\"\"Axis limits, ticks and the data-to-pixel transform shared by both back ends.\n",
+    "\n",
+    "    Expects finite points (see finite_points); with none at all the axes span [0, 1].\"\"\"\n",
+    "    xs, ys = np.concatenate([x, x_fit]), np.concatenate([y, y_fit])\n",
+    "    if xs.size == 0:\n",
+    "        xs = ys = np.array([0.0, 1.0])\n",
+    "    pad_x, pad_y = 0.05 * np.ptp(xs) or 1.0, 0.05 * np.ptp(ys) or 1.0\n",
+    "    xlim, ylim = (xs.min() - pad_x, xs.max() + pad_x), (ys.min() - pad_y, ys.max() + pad_y)\n",
+    "    l, t, r, b = PLOT_BOX\n",
+    "    px = lambda u: l + (u - xlim[0]) / (xlim[1] - xlim[0]) * (r - l)\n",
+    "    py = lambda u: b - (u - ylim[0]) / (ylim[1] - ylim[0]) * (b - t)\n",
+    "    xt, yt = nice_ticks(*xlim), nice_ticks(*ylim)\n",
+    "    return px, py, xt[(xt >= xlim[0]) & (xt <= xlim[1])], yt[(yt >= ylim[0]) & (yt <= ylim[1])]\n",
+    "\n",
+    "SVG_DEFS = ('<style>text{font:12px sans-serif}.t{font-size:14px;text-anchor:middle}'\n",
+    "            '.x{text-anchor:middle}.y{text-anchor:end}.a{fill:none;stroke:#000}'\n",
+    "            '.d{stroke:#00f;stroke-width:1.5}.f{fill:none;stroke:#000;stroke-width:1.5}</style>'\n",
+    "            '<defs><symbol id=\"m\" overflow=\"visible\"><path d=\"M-5 0h10M0-5v10\"/></symbol></defs>')\n",
+    "\n",
+    "def svg_label(text):\n",
+    "    \"\"\"Escape a label and raise a trailing ^-exponent with <tspan>.\"\"\"\n",
+    "    text = text.replace('&', '&amp;').replace('<', '&lt;')\n",
+    "    base, _, sup = text.partition('^')\n",
+    "    return base + (f'<tspan dy=\"-5\" font-size=\"9\">{sup}</tspan>' if sup else '')\n",
+    "\n",
+    "def svg_plot(x, y, x_fit, y_fit, title='', xlabel='', ylabel='', dy=0):\n",
+    "    \"\"\"One scatter-plus-fit plot as an SVG group, translated down by dy px.\n",
+    "\n",
+    "    Non-finite points are left out, so a series without a valid fit shows its data only.\"\"\"\n",
+    "    x, y = finite_points(x, y)\n",
+    "    x_fit, y_fit = finite_points(x_fit, y_fit)\n",
+    "    px, py, xt, yt = plot_layout(x, y, x_fit, y_fit)\n",
+    "    l, t, r, b = PLOT_BOX\n",
+    "    out = [f'<g transform=\"translate(0 {dy})\"><rect class=\"a\" x=\"{l}\" y=\"{t}\" width=\"{r - l}\" height=\"{b - t}\"/>']\n",
+    "    ticks = ''.join(f'M{px(u):.1f} {b}v5' for u in xt) + ''.join(f'M{l} {py(u):.1f}h-5' for u in yt)\n",
+    "    out.append(f'<path class=\"a\" d=\"{ticks}\"/>')\n",
+    "    out += [f'<text class=\"x\" x=\"{px(u):.1f}\" y=\"{b + 19}\">{u:g}</text>' for u in xt]\n",
+    "    out += [f'<text class=\"y\" x=\"{l - 8}\" y=\"{py(u) + 4:.1f}\">{u:g}</text>' for u in yt]\n",
+    "    if x_fit.size:\n",
+    "        pts = ' '.join(f'{a:.1f},{c:.1f}' for a, c in zip(px(x_fit), py(y_fit)))\n",
+    "        out.append(f'<polyline class=\"f\" points=\"{pts}\"/>')\n",
+    "    out.append(f'<g class=\"d\">' + ''.join(f'<use href=\"#m\" x=\"{a:.1f}\" y=\"{c:.1f}\"/>'\n",
+    "                                         for a, c in zip(px(x), py(y))) + '</g>')\n",
+    "    out.append(f'<use class=\"d\" href=\"#m\" x=\"{l + 20}\" y=\"{t + 17}\"/><text x=\"{l + 35}\" y=\"{t + 21}\">Data</text>'\n",
+    "               f'<path class=\"f\" d=\"M{l + 10} {t + 35}h20\"/><text x=\"{l + 35}\" y=\"{t + 39}\">Fit</text>')\n",
+    "    out.append(f'<text class=\"t\" x=\"{(l + r) / 2}\" y=\"{t - 14}\">{svg_label(title)}</text>'\n",
+    "               f'<text class=\"x\" x=\"{(l + r) / 2}\" y=\"{b + 42}\">{svg_label(xlabel)}</text>'\n",
+    "               f'<text class=\"x\" transform=\"translate(18 {(t + b) / 2})rotate(-90)\">{svg_label(ylabel)}</text></g>')\n",
+    "    return ''.join(out)\n",
+    "\n",
+    "def svg_document(groups):\n",
+    "    \"\"\"Stack plot groups vertically in one SVG sharing the style and marker definitions.\"\"\"\n",
+    "    return (f'<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"{PLOT_W}\" height=\"{PLOT_H * len(groups)}\">'\n",
+    "            + SVG_DEFS + ''.join(groups) + '</svg>\\n')\n",
+    "\n",
+    "# 5x8 bitmap font for ASCII 0x20-0x7e, five column bytes per glyph (bit 0 = top row)\n",
+    "FONT_5X8 = bytes.fromhex(\n",
+    "    '000000000000005f00000007000700147f147f14242a7f2a12231308646236495620500008070300'\n",
+    "    '001c2241000041221c002a1c7f1c2a08083e08080080703000080808080800006060002010080402'\n",
+    "    '3e5149453e00427f400072494949462141494d331814127f1027454545393c4a4949314121110907'\n",
+    "    '3649494936464949291e000014000000403400000008142241141414141400412214080201590906'\n",
+    "    '3e415d594e7c1211127c7f494949363e414141227f4141413e7f494949417f090909013e41415173'\n",
+    "    '7f0808087f00417f41002040413f017f081422417f404040407f021c027f7f0408107f3e4141413e'\n",
+    "    '7f090909063e4151215e7f09192946264949493203017f01033f4040403f1f2040201f3f4038403f'\n",
+    "    '631408146303047804036159494d43007f4141410204081020004141417f04020102044040404040'\n",
+    "    '000307080020545478407f284444383844444428384444287f385454541800087e090218a4a49c78'\n",
+    "    '7f0804047800447d40002040403d007f1028440000417f40007c047804787c080404783844444438'\n",
+    "    'fc1824241818242418fc7c08040408485454542404043f44243c4040207c1c2040201c3c4030403c'\n",
+    "    '44281028444c9090907c4464544c440008364100000077000000413608000201020402')\n",
+    "\n",
+    "def _glyph(ch):\n",
+    "    i = (ord(ch) - 0x20) * 5\n",
+    "    cols = FONT_5X8[i:i + 5] if 0 <= i < len(FONT_5X8) else b'\\0' * 5\n",
+    "    return (np.frombuffer(cols, dtype=np.uint8)[None, :] >> np.arange(8, dtype=np.uint8)[:, None]) & 1\n",
+    "\n",
+    "def raster_text(img, x, y, text, color=(0, 0, 0), anchor='start', rotate=False):\n",
+    "    \"\"\"Draw text with its top-left (or centre/end per anchor) at (x, y); '^' starts a superscript.\"\"\"\n",
+    "    base, _, sup = text.partition('^')\n",
+    "    glyphs = [(_glyph(c), 0) for c in base] + [(_glyph(c), -3) for c in sup]\n",
+    "    width = 6 * len(glyphs)\n",
+    "    block = np.zeros((11, width + 1), dtype=np.uint8)\n",
+    "    for k, (g, shift) in enumerate(glyphs):\n",
+    "        block[3 + shift:11 + shift, 6 * k:6 * k + 5] |= g\n",
+    "    if rotate:\n",
+    "        block = np.rot90(block)\n",
+    "    h, w = block.shape\n",
+    "    off = {'start': 0, 'middle': 0.5, 'end': 1.0}[anchor]\n",
+    "    x0, y0 = (int(x - w / 2), int(y - off * h)) if rotate else (int(x - off * w), int(y - 3))\n",
+    "    ys, xs = np.nonzero(block)\n",
+    "    ys, xs = ys + y0, xs + x0\n",
+    "    keep = (ys >= 0) & (ys < img.shape[0]) & (xs >= 0) & (xs < img.shape[1])\n",
+    "    img[ys[keep], xs[keep]] = color\n",
+    "\n",
+    "def raster_polyline(img, xs, ys, color=(0, 0, 0), width=1):\n",
+    "    \"\"\"Draw connected segments by dense sampling.\"\"\"\n",
+    "    xs, ys = np.asarray(xs, dtype=float), np.asarray(ys, dtype=float)\n",
+    "    n = np.maximum(np.ceil(np.hypot(np.diff(xs), np.diff(ys))).astype(int), 1)\n",
+    "    f = np.arange(n.sum()) - np.repeat(np.cumsum(n) - n, n)\n",
+    "    f = f / np.repeat(n, n)\n",
+    "    seg = np.repeat(np.arange(n.size), n)\n",
+    "    px = np.append(xs[seg] + f * np.diff(xs)[seg], xs[-1])\n",
+    "    py = np.append(ys[seg] + f * np.diff(ys)[seg], ys[-1])\n",
+    "    for o in range(width):\n",
+    "        r, c = np.rint(py + o - width // 2).astype(int), np.rint(px).astype(int)\n",
+    "        keep = (r >= 0) & (r < img.shape[0]) & (c >= 0) & (c < img.shape[1])\n",
+    "        img[r[keep], c[keep]] = color\n",
+    "\n",
+    "def png_plot(x, y, x_fit, y_fit, title='', xlabel='', ylabel=''):\n",
+    "    \"\"\"Rasterize one scatter-plus-fit plot and return the PNG bytes; non-finite points are left out.\"\"\"\n",
+    "    x, y = finite_points(x, y)\n",
+    "    x_fit, y_fit = finite_points(x_fit, y_fit)\n",
+    "    px, py, xt, yt = plot_layout(x, y, x_fit, y_fit)\n",
+    "    l, t, r, b = PLOT_BOX\n",
+    "    img = np.full((PLOT_H, PLOT_W, 3), 255, dtype=np.uint8)\n",
+    "    raster_polyline(img, [l, r, r, l, l], [t, t, b, b, t])\n",
+    "    for u in xt:\n",
+    "        raster_polyline(img, [px(u)] * 2, [b, b + 5])\n",
+    "        raster_text(img, px(u), b + 9, f'{u:g}', anchor='middle')\n",
+    "    for u in yt:\n",
+    "        raster_polyline(img, [l - 5, l], [py(u)] * 2)\n",
+    "        raster_text(img, l - 8, py(u) - 1, f'{u:g}', anchor='end')\n",
+    "    if x_fit.size:\n",
+    "        raster_polyline(img, px(x_fit), py(y_fit), width=2)\n",
+    "    for a, c in zip(px(x), py(y)):\n",
+    "        raster_polyline(img, [a - 5, a + 5], [c, c], color=(0, 0, 255), width=2)\n",
+    "        raster_polyline(img, [a, a], [c - 5, c + 5], color=(0, 0, 255))\n",
+    "    raster_polyline(img, [l + 15, l + 25], [t + 15] * 2, color=(0, 0, 255), width=2)\n",
+    "    raster_polyline(img, [l + 20] * 2, [t + 10, t + 20], color=(0, 0, 255))\n",
+    "    raster_text(img, l + 35, t + 12, 'Data')\n",
+    "    raster_polyline(img, [l + 10, l + 30], [t + 33] * 2, width=2)\n",
+    "    raster_text(img, l + 35, t + 30, 'Fit')\n",
+    "    raster_text(img, (l + r) / 2, t - 22, title, anchor='middle')\n",
+    "    raster_text(img, (l + r) / 2, b + 30, xlabel, anchor='middle')\n",
+    "    raster_text(img, 18, (t + b) / 2, ylabel, anchor='middle', rotate=True)\n",
+    "\n",
+    "    raw = np.zeros((PLOT_H, 1 + 3 * PLOT_W), dtype=np.uint8)  # filter byte 0 per row\n",
+    "    raw[:, 1:] = img.reshape(PLOT_H, -1)\n",
+    "    chunk = lambda tag, data: (struct.pack('>I', len(data)) + tag + data\n",
+    "                               + struct.pack('>I', zlib.crc32(tag + data)))\n",
+    "    return (b'\\x89PNG\\r\\n\\x1a\\n' + chunk(b'IHDR', struct.pack('>IIBBBBB', PLOT_W, PLOT_H, 8, 2, 0, 0, 0))\n",
+    "            + chunk(b'IDAT', zlib.compress(raw.tobytes(), 6)) + chunk(b'IEND', b''))\n",
+    "\n",
+    "def lineweaver_burk_plot_data(S, v):\n",
+    "    \"\"\"Transformed data and the 100-point fit line of Step 2.\"\"\"\n",
+    "    x, y = 1 / S, 1 / v\n",
+    "    fit = lineweaver_burk_batch(S, v, np.array([0, len(S)]))\n",
+    "    x_fit = np.linspace(min(x), max(x), 100)\n",
+    "    return x, y, x_fit, fit['m'][0] * x_fit + fit['b'][0]\n",
+    "\n",
+    "LB_LABELS = dict(title='Lineweaver-Burk Plot for Pepsin', xlabel='1/[S] (mM)^-1', ylabel='1/v s(mM)^-1')\n",
+    "\n",
+    "svg = svg_document([svg_plot(*lineweaver_burk_plot_data(S, v), **LB_LABELS)])\n",
+    "png = png_plot(*lineweaver_burk_plot_data(S, v), **LB_LABELS)\n",
+    "committed = os.path.getsize('Linear fit svg/Linearweaver-Burk Plot for pepsin.svg')\n",
+    "print(f\"matplotlib SVG (committed): {committed:6d} bytes\")\n",
+    "print(f\"native SVG                : {len(svg):6d} bytes\")\n",
+    "print(f\"native PNG                : {len(png):6d} bytes\")\n",
+    "\n",
+    "# A degenerate series (every [S] equal) has no finite fit; its plot shows the data only\n",
+    "S_deg, v_deg = np.full(4, 0.5), np.array([0.0060, 0.0062, 0.0059, 0.0061])\n",
+    "deg = lineweaver_burk_plot_data(S_deg, v_deg)\n",
+    "print(f\"degenerate series         : fit finite = {np.isfinite(deg[3]).any()},\"\n",
+    "      f\" SVG {len(svg_document([svg_plot(*deg, **LB_LABELS)]))} bytes, PNG {len(png_plot(*deg, **LB_LABELS))} bytes\")"
+   ]
+  },
+  {
+   "cell_type": "markdown",
+   "id": "fd5cc391-89af-4465-acb2-22901a1c0b4b",
+   "metadata": {},
+   "source": [
+    "The benchmark renders 10,000 synthetic series as individual SVG files, as one shared-definition SVG report and as PNGs spread over all cores, and compares them with `plt.savefig` on a sample of the same plots."
+   ]
+  },
+  {
+   "cell_type": "code",
+   "execution_count": 103,
+   "id": "fa0b07e9-e22a-4ed5-9865-8a8ba3991b67",
+   "metadata": {},
+   "outputs": [
+    {
+     "name": "stdout",
+     "output_type": "stream",
+     "text": [
+      "renderer                 plots/s  bytes/plot\n",
+      "matplotlib SVG+PNG           4.1      54,773\n",
+      "native SVG files           4,802       2,835\n",
+      "native SVG report          4,680       2,468\n",
+      "native PNG (parallel)        149       4,511\n"
+     ]
+    }
+   ],
+   "source": [
+    "import io\n",
+    "import matplotlib\n",
+    "import matplotlib.pyplot as plt\n",
+    "\n",
+    "n_plots = 10_000\n",
+    "S_r, v_r, off_r = synthetic_plate(n_plots, seed=9)\n",
+    "series = [lineweaver_burk_plot_data(S_r[off_r[j]:off_r[j + 1]], v_r[off_r[j]:off_r[j + 1]])\n",
+    "          for j in range(n_plots)]\n",
+    "labels = dict(LB_LABELS, title='Lineweaver-Burk Plot')\n",
+    "\n",
+    "t0 = time.perf_counter()\n",
+    "svgs = [svg_document([svg_plot(*data, **labels)]) for data in series]\n",
+    "t_svg = time.perf_counter() - t0\n",
+    "\n",
+    "t0 = time.perf_counter()\n",
+    "report = svg_document([svg_plot(*data, **labels, dy=PLOT_H * j) for j, data in enumerate(series)])\n",
+    "t_report = time.perf_counter() - t0\n",
+    "\n",
+    "t0 = time.perf_counter()\n",
+    "pngs = WorkStealingPool().map(lambda data: png_plot(*data, **labels), series)\n",
+    "t_png = time.perf_counter() - t0\n",
+    "\n",
+    "n_mpl = 20\n",
+    "backend = matplotlib.get_backend()\n",
+    "plt.switch_backend('Agg')\n",
+    "mpl_bytes = {'svg': 0, 'png': 0}\n",
+    "t0 = time.perf_counter()\n",
+    "for x_, y_, xf, yf in series[:n_mpl]:\n",
+    "    fig = plt.figure(figsize=(6, 4))\n",
+    "    plt.plot(x_, y_, '+', color='blue', markersize=8, label='Data')\n",
+    "    plt.plot(xf, yf, color='black', label='Fit')\n",
+    "    plt.xlabel('$\\\\mathrm{1/[S]} \\\\; (mM)^{-1}$')\n",
+    "    plt.ylabel('$\\\\mathrm{1/[v]} \\\\; s(mM)^{-1}$')\n",
+    "    plt.title(labels['title'])\n",
+    "    plt.legend()\n",
+    "    for fmt in mpl_bytes:\n",
+    "        buf = io.BytesIO()\n",
+    "        fig.savefig(buf, format=fmt, bbox_inches='tight')\n",
+    "        mpl_bytes[fmt] += buf.tell()\n",
+    "    plt.close(fig)\n",
+    "t_mpl = time.perf_counter() - t0\n",
+    "plt.switch_backend(backend)\n",
+    "\n",
+    "print(f\"{'renderer':<22} {'plots/s':>9} {'bytes/plot':>11}\")\n",
+    "print(f\"{'matplotlib SVG+PNG':<22} {n_mpl / t_mpl:9,.1f} {sum(mpl_bytes.values()) / n_mpl:11,.0f}\")\n",
+    "print(f\"{'native SVG files':<22} {n_plots / t_svg:9,.0f} {sum(map(len, svgs)) / n_plots:11,.0f}\")\n",
+    "print(f\"{'native SVG report':<22} {n_plots / t_report:9,.0f} {len(report) / n_plots:11,.0f}\")\n",
+    "print(f\"{'native PNG (parallel)':<22} {n_plots / t_png:9,.0f} {sum(map(len, pngs)) / n_plots:11,.0f}\")"
+   ]
+  },
+  {
+   "cell_type": "markdown",
+   "id": "e073a95d-2fa5-40ae-8623-844381a66b48",
+   "metadata": {},
+   "source": [
+    "### Step 12. Stage timers and a reproducible pipeline benchmark\n",
+    "The notebook goes from `genfromtxt` to the `1/S`, `1/v` transform, then to `lstsq`, `print` and `savefig`, and nothing records where the time goes. `StageProfiler` keeps a call count, an item count and the total and worst wall time for each named stage. When it is disabled, `stage()` returns one shared no-op context manager, so instrumented code costs a method call and an attribute check.\n",
+    "\n",
+    "`lineweaver_burk_pipeline` runs the full load \u2192 transform \u2192 fit \u2192 derive \u2192 render path over a rate table, using the streaming reader of Step 5, the SVG renderer of Step 11 and the same transform, reduction and closed-form kernels that `lineweaver_burk_batch` of Step 3 is built from. Each step is wrapped in its own stage, so the benchmark times the production kernels."
+   ]
+  },
+  {
+   "cell_type": "code",
+   "execution_count": 104,
+   "id": "4e484e89-bbd2-483d-8e30-810d3bee3d97",
+   "metadata": {},
+   "outputs": [
+    {
+     "name": "stdout",
+     "output_type": "stream",
+     "text": [
+      "vmax = 0.0145 mM/s, Km = 0.3267 mM, k2 = 0.5166 s^-1\n",
+      "stage       calls        items   total ms   ns/item\n",
+      "parse           1          227       0.45    1989.6\n",
+      "transform       1            7       0.01    1802.0\n",
+      "fit             1            1       0.07   71806.0\n",
+      "derive          1            1       0.01    7145.0\n",
+      "render          1            1       0.60  600371.0\n"
+     ]
+    }
+   ],
+   "source": [
+    "import contextlib\n",
+    "import platform\n",
+    "\n",
+    "class StageProfiler:\n",
+    "    \"\"\"Per-stage call counts, item counts and wall time; a no-op unless enabled.\"\"\"\n",
+    "\n",
+    "    _noop = contextlib.nullcontext()\n",
+    "\n",
+    "    class _Stage:\n",
+    "        __slots__ = ('prof', 'name', 'items', 't0')\n",
+    "\n",
+    "        def __init__(self, prof, name, items):\n",
+    "            self.prof, self.name, self.items = prof, name, items\n",
+    "\n",
+    "        def __enter__(self):\n",
+    "            self.t0 = time.perf_counter_ns()\n",
+    "\n",
+    "        def __exit__(self, *exc):\n",
+    "            dt = time.perf_counter_ns() - self.t0\n",
+    "            with self.prof._lock:\n",
+    "                s = self.prof.stats.setdefault(self.name, {'calls': 0, 'items': 0, 'total_ns': 0, 'max_ns': 0})\n",
+    "                s['calls'] += 1\n",
+    "                s['items'] += self.items\n",
+    "                s['total_ns'] += dt\n",
+    "                s['max_ns'] = max(s['max_ns'], dt)\n",
+    "\n",
+    "    def __init__(self, enabled=False):\n",
+    "        self.enabled = enabled\n",
+    "        self.stats = {}\n",
+    "        self._lock = threading.Lock()\n",
+    "\n",
+    "    def stage(self, name, items=0):\n",
+    "        if not self.enabled:\n",
+    "            return self._noop\n",
+    "        return self._Stage(self, name, items)\n",
+    "\n",
+    "    def reset(self):\n",
+    "        self.stats = {}\n",
+    "\n",
+    "    def to_json(self):\n",
+    "        return json.dumps(self.stats, indent=1)\n",
+    "\n",
+    "    def report(self):\n",
+    "        lines = [f\"{'stage':<10} {'calls':>6} {'items':>12} {'total ms':>10} {'ns/item':>9}\"]\n",
+    "        for name, s in self.stats.items():\n",
+    "            per = s['total_ns'] / s['items'] if s['items'] else float('nan')\n",
+    "            lines.append(f\"{name:<10} {s['calls']:6d} {s['items']:12,d} {s['total_ns'] / 1e6:10.2f} {per:9.1f}\")\n",
+    "        return '\\n'.join(lines)\n",
+    "\n",
+    "PROFILE = StageProfiler()\n",
+    "\n",
+    "def lineweaver_burk_pipeline(path, points_per_series=None, E0=0.028, render=10, profile=PROFILE):\n",
+    "    \"\"\"Parse a rate table, fit every series of points_per_series rows (default: the\n",
+    "    whole table as one series) and render the first `render` Lineweaver-Burk plots.\n",
+    "\n",
+    "    Rows left over after the last full series form one shorter final series, or join the\n",
+    "    previous series when there is only one of them, since a 1-point series cannot be fitted.\"\"\"\n",
+    "    with profile.stage('parse', os.path.getsize(path)):\n",
+    "        chunks = list(iter_rate_chunks(path))\n",
+    "        S = np.concatenate([c[0] for c in chunks])\n",
+    "        v = np.concatenate([c[1] for c in chunks])\n",
+    "    n_rows = S.size\n",
+    "    step = points_per_series or n_rows\n",
+    "    if n_rows < 2:\n",
+    "        raise ValueError(f\"{path} has {n_rows} data rows; a fit needs at least 2\")\n",
+    "    offsets = np.append(np.arange(0, n_rows, step), n_rows)\n",
+    "    if offsets[-1] - offsets[-2] < 2:\n",
+    "        offsets = np.delete(offsets, -2)\n",
+    "    n_series = len(offsets) - 1\n",
+    "\n",
+    "    with profile.stage('transform', n_rows):\n",
+    "        x, y = lineweaver_burk_transform(S, v)\n",
+    "    with profile.stage('fit', n_series):\n",
+    "        m, b, _ = lineweaver_burk_line(*lineweaver_burk_reduce(x, y, offsets))\n",
+    "    with profile.stage('derive', n_series):\n",
+    "        vmax, Km, k2 = lineweaver_burk_derive(m, b, E0)\n",
+    "    n_render = min(render, n_series)\n",
+    "    with profile.stage('render', n_render):\n",
+    "        plots = []\n",
+    "        for j in range(n_render):\n",
+    "            xj, yj = x[offsets[j]:offsets[j + 1]], y[offsets[j]:offsets[j + 1]]\n",
+    "            x_fit = np.linspace(xj.min(), xj.max(), 100)\n",
+    "            plots.append(svg_document([svg_plot(xj, yj, x_fit, m[j] * x_fit + b[j], **LB_LABELS)]))\n",
+    "    return {'vmax': vmax, 'Km': Km, 'k2': k2, 'plots': plots}\n",
+    "\n",
+    "PROFILE.enabled = True\n",
+    "res = lineweaver_burk_pipeline('pepsin.txt', render=1)\n",
+    "PROFILE.enabled = False\n",
+    "print(f\"vmax = {res['vmax'][0]:.4f} mM/s, Km = {res['Km'][0]:.4f} mM, k2 = {res['k2'][0]:.4f} s^-1\")\n",
+    "print(PROFILE.report())"
+   ]
+  },
+  {
+   "cell_type": "markdown",
+   "id": "b4262cc8-92c9-4c3b-a6d9-257dbdd0193c",
+   "metadata": {},
+   "source": [
+    "The cost of the instrumentation itself, per `with PROFILE.stage(...)` block:"
+   ]
+  },
+  {
+   "cell_type": "code",
+   "execution_count": 105,
+   "id": "52b1a09b-f5d2-440f-9f6f-cd1c23ed67f0",
+   "metadata": {},
+   "outputs": [
+    {
+     "name": "stdout",
+     "output_type": "stream",
+     "text": [
+      "disabled:    437 ns per stage\n",
+      "enabled :   2160 ns per stage\n"
+     ]
+    }
+   ],
+   "source": [
+    "def empty_stage_ns(prof, n=1_000_000):\n",
+    "    t0 = time.perf_counter_ns()\n",
+    "    for _ in range(n):\n",
+    "        with prof.stage('noop'):\n",
+    "            pass\n",
+    "    return (time.perf_counter_ns() - t0) / n\n",
+    "\n",
+    "def empty_loop_ns(n=1_000_000):\n",
+    "    t0 = time.perf_counter_ns()\n",
+    "    for _ in range(n):\n",
+    "        pass\n",
+    "    return (time.perf_counter_ns() - t0) / n\n",
+    "\n",
+    "loop = empty_loop_ns()\n",
+    "print(f\"disabled: {empty_stage_ns(StageProfiler(False)) - loop:6.0f} ns per stage\")\n",
+    "print(f\"enabled : {empty_stage_ns(StageProfiler(True)) - loop:6.0f} ns per stage\")"
+   ]
+  },
+  {
+   "cell_type": "markdown",
+   "id": "5b725f07-8f2a-4244-8c52-dfe52fce47bc",
+   "metadata": {},
+   "source": [
+    "The benchmark suite writes synthetic plates of 7-point series, from the size of `pepsin.txt` up to $10^7$ points (add `10**8` to `BENCH_SIZES` on a machine with about 10 GB of free memory). It runs the pipeline with profiling enabled and stores, for every size and stage, the best-of-`repeats` time per item. The environment is recorded next to the numbers. The first run writes `pipeline_baseline.json`. Later runs compare against it and flag every stage that is more than `tolerance` times slower than the baseline. Absolute times only compare on the same machine, so when the recorded environment differs the comparison is skipped and the differences are printed; delete the file to record a baseline for the new machine."
+   ]
+  },
+  {
+   "cell_type": "code",
+   "execution_count": 106,
+   "id": "18f9f866-270f-4e46-b78f-52d76929e57d",
+   "metadata": {},
+   "outputs": [
+    {
+     "name": "stdout",
+     "output_type": "stream",
+     "text": [
+      "    points      parse  transform        fit     derive     render\n",
+      "         7     807.44     670.71   31008.00    3487.00  308435.00\n",
+      "     1,000      34.80       8.06     359.98      31.83  258100.60\n",
+      "   100,000      18.79       2.25      92.08       2.91  243879.00\n",
+      "10,000,000      21.93      15.05     235.80       4.26  268153.70\n",
+      "baseline written to pipeline_baseline.json\n"
+     ]
+    }
+   ],
+   "source": [
+    "BENCH_SIZES = (7, 10**3, 10**5, 10**7)\n",
+    "BASELINE = 'pipeline_baseline.json'\n",
+    "\n",
+    "def write_plate_table(path, n_points, seed=10):\n",
+    "    \"\"\"pepsin.txt-style table holding a synthetic plate of 7-point series.\"\"\"\n",
+    "    S_t, v_t, _ = synthetic_plate(-(-n_points // 7), seed=seed)\n",
+    "    with open(path, 'w') as f:\n",
+    "        f.write('# Synthetic plate, 7 points per series\\n\\nS / mM\\t\\tv / mM.s-1\\n')\n",
+    "        np.savetxt(f, np.column_stack([S_t[:n_points], v_t[:n_points]]), fmt='%.6g', delimiter='\\t\\t')\n",
+    "\n",
+    "def cpu_model():\n",
+    "    \"\"\"CPU model name from /proc/cpuinfo, or platform.processor() elsewhere.\"\"\"\n",
+    "    try:\n",
+    "        with open('/proc/cpuinfo') as f:\n",
+    "            for line in f:\n",
+    "                if line.startswith('model name'):\n",
+    "                    return line.split(':', 1)[1].strip()\n",
+    "    except OSError:\n",
+    "        pass\n",
+    "    return platform.processor()\n",
+    "\n",
+    "def run_benchmarks(sizes=BENCH_SIZES, repeats=3):\n",
+    "    \"\"\"Best-of-repeats ns per item for every stage and dataset size.\"\"\"\n",
+    "    results = {}\n",
+    "    prof = StageProfiler(True)\n",
+    "    with tempfile.TemporaryDirectory() as tmp:\n",
+    "        for n_points in sizes:\n",
+    "            path = os.path.join(tmp, f'plate_{n_points}.txt')\n",
+    "            write_plate_table(path, n_points)\n",
+    "            best = {}\n",
+    "            for _ in range(repeats):\n",
+    "                prof.reset()\n",
+    "                lineweaver_burk_pipeline(path, points_per_series=7, profile=prof)\n",
+    "                for name, s in prof.stats.items():\n",
+    "                    per = s['total_ns'] / max(s['items'], 1)\n",
+    "                    best[name] = min(best.get(name, np.inf), per)\n",
+    "            results[str(n_points)] = best\n",
+    "    return {'environment': {'python': platform.python_version(), 'numpy': np.__version__,\n",
+    "                            'machine': platform.machine(), 'cpu': cpu_model(), 'cpus': os.cpu_count()},\n",
+    "            'unit': 'ns per item (bytes for parse, points for transform, series for fit/derive, plots for render)',\n",
+    "            'results': results}\n",
+    "\n",
+    "def environment_mismatch(current, baseline):\n",
+    "    \"\"\"Environment fields that differ between two benchmark runs, as {field: (baseline, current)}.\"\"\"\n",
+    "    env, ref = current['environment'], baseline['environment']\n",
+    "    return {k: (ref.get(k), env[k]) for k in env if ref.get(k) != env[k]}\n",
+    "\n",
+    "def compare_to_baseline(current, baseline, tolerance=1.5):\n",
+    "    \"\"\"Stages that got more than `tolerance` times slower, as (size, stage, ratio).\n",
+    "\n",
+    "    Only meaningful when environment_mismatch(current, baseline) is empty.\"\"\"\n",
+    "    slower = []\n",
+    "    for size, stages in current['results'].items():\n",
+    "        for name, per in stages.items():\n",
+    "            ref = baseline['results'].get(size, {}).get(name)\n",
+    "            if ref and per > tolerance * ref:\n",
+    "                slower.append((size, name, per / ref))\n",
+    "    return slower\n",
+    "\n",
+    "bench = run_benchmarks()\n",
+    "print(f\"{'points':>10} \" + ' '.join(f\"{s:>10}\" for s in ('parse', 'transform', 'fit', 'derive', 'render')))\n",
+    "for size, stages in bench['results'].items():\n",
+    "    print(f\"{int(size):>10,} \" + ' '.join(f\"{stages[s]:10.2f}\" for s in ('parse', 'transform', 'fit', 'derive', 'render')))\n",
+    "\n",
+    "if os.path.exists(BASELINE):\n",
+    "    with open(BASELINE) as f:\n",
+    "        baseline = json.load(f)\n",
+    "    mismatch = environment_mismatch(bench, baseline)\n",
+    "    if mismatch:\n",
+    "        print(f\"{BASELINE} was recorded in a different environment, not comparing:\")\n",
+    "        for k, (ref, cur) in mismatch.items():\n",
+    "            print(f\"  {k}: baseline {ref}, here {cur}\")\n",
+    "    else:\n",
+    "        regressions = compare_to_baseline(bench, baseline)\n",
+    "        for size, name, ratio in regressions:\n",
+    "            print(f\"REGRESSION: {name} at {int(size):,} points is {ratio:.2f}x slower than the baseline\")\n",
+    "        if not regressions:\n",
+    "            print(f\"no stage slower than the baseline in {BASELINE}\")\n",
+    "else:\n",
+    "    with open(BASELINE, 'w') as f:\n",
+    "        json.dump(bench, f, indent=1)\n",
+    "    print(f\"baseline written to {BASELINE}\")"
+   ]
+  },
+  {
+   "cell_type": "markdown",
+   "id": "f2dbcbdd-d39e-4239-bdcc-1d55d1f92069",
+   "metadata": {},
+   "source": [
+    "### Step 13. Weighted and robust fitting for noisy plates\n",
+    "The unweighted fit of $y=1/v$ treats every point as equally reliable. But the error of $1/v$ grows like the square of $1/v$: by error propagation\n",
+    "<p align='center'>\n",
+    "    $$\\sigma_y=\\left|\\frac{dy}{dv}\\right|\\sigma_v=\\frac{\\sigma_v}{v^2},\\quad w_i=\\frac{1}{\\sigma_{y,i}^2}=\\frac{v_i^4}{\\sigma_{v,i}^2}$$\n",
+    "</p>\n",
+    "so a single bad low-rate well can pull $K_M$ across a whole plate. The weighted closed-form solution uses the weighted sums $S_w=\\sum w_i$, $S_{wx}=\\sum w_ix_i$, and so on:\n",
+    "<p align='center'>\n",
+    "    $$m=\\frac{S_wS_{wxy}-S_{wx}S_{wy}}{S_wS_{wxx}-S_{wx}^2},\\quad b=\\frac{S_{wy}S_{wxx}-S_{wxy}S_{wx}}{S_wS_{wxx}-S_{wx}^2}$$\n",
+    "</p>\n",
+    "The weights come from a user-supplied $\\sigma_v$, or from an error model: `'relative'` ($\\sigma_v\\propto v$, so $w=v^2$), `'absolute'` ($\\sigma_v$ constant, so $w=v^4$) or `'none'` (the unweighted fit of Step 2). On top of the weights there are three outlier-resistant modes:\n",
+    "\n",
+    "- **Huber** and **Tukey** iteratively reweighted least squares (IRLS). Residuals are standardised by a per-series robust scale, $1.4826\\times$ the median absolute weighted residual. Tukey's biweight gives zero weight to gross outliers; it starts from the Huber solution because it is not convex. A series stops iterating once $m$ and $b$ change by less than `tol` relative (default $10^{-6}$). From then on it keeps those values, so its result depends only on its own data and not on which series share its chunk. Converged series leave the working set whenever half of it has finished, as in the rate-law fitter of Step 9. `tol` bounds the last step, not the distance to the converged fit. IRLS converges only linearly, and a few series stop at `max_iter`: slow Huber fits, and Tukey fits that alternate between two weightings. The benchmark measures that distance.\n",
+    "- **RANSAC**: random two-point lines are scored by the number of points within a relative tolerance $|r_i|/y_i\\le\\tau$ (the relative deviation of $v$). The best line's inliers are then refitted with the weights.\n",
+    "\n",
+    "All series of a chunk are processed together. For the per-series medians the residuals are scattered into a $k\\times n_{max}$ grid (one row per series, padded with $+\\infty$) that is sorted in place along its rows. Every intermediate lives in a `FitScratch` arena that each worker thread allocates once and reuses for all of its chunks and iterations, so the inner loops write into preallocated buffers through `out=` instead of allocating arrays. Gathers use `np.take(..., mode='clip')`; the indices are in range by construction, and the default `mode='raise'` would copy through a temporary array the size of the output. Only the working-set compaction allocates index arrays, a few times per chunk."
+   ]
+  },
+  {
+   "cell_type": "code",
+   "execution_count": 107,
+   "id": "dc058746-5785-43ab-9943-58327692c3cd",
+   "metadata": {},
+   "outputs": [
+    {
+     "name": "stdout",
+     "output_type": "stream",
+     "text": [
+      "fit                    vmax       Km       k2  weight of corrupted point\n",
+      "clean, unweighted    0.0145   0.3267   0.5166  1\n",
+      "unweighted           0.0174   0.5922   0.6226  1\n",
+      "weighted (1/v)       0.0150   0.4100   0.5347  0.0278\n",
+      "Huber                0.0145   0.3271   0.5167  2.24e-05\n",
+      "Tukey                0.0145   0.3269   0.5167  0\n",
+      "RANSAC               0.0145   0.3269   0.5166  0\n",
+      "unknown method 'Huber', expected one of ('wls', 'huber', 'tukey', 'ransac')\n"
+     ]
+    }
+   ],
+   "source": [
+    "HUBER_C, TUKEY_C, MAD_SCALE = 1.345, 4.685, 1.4826\n",
+    "ROBUST_METHODS = ('wls', 'huber', 'tukey', 'ransac')\n",
+    "ERROR_MODELS = ('relative', 'absolute', 'none')\n",
+    "\n",
+    "class FitScratch:\n",
+    "    \"\"\"Per-thread buffers for the robust fitters; they only grow when a larger chunk arrives.\"\"\"\n",
+    "\n",
+    "    ROW_FLOAT = ('x', 'y', 'w0', 'sw0', 'w', 'r', 'u', 't', 'mask')\n",
+    "    ROW_INT = ('seg', 'cell')\n",
+    "    SERIES_FLOAT = ('Sw', 'Swx', 'Swy', 'Swxx', 'Swxy', 'd', 'm', 'b', 'pm', 'pb', 's', 'q',\n",
+    "                    'nf', 'best_m', 'best_b', 'best_n', 'count', 'r1', 'r2')\n",
+    "    SERIES_INT = ('lo', 'hi', 'i', 'j')\n",
+    "    SERIES_BOOL = ('better', 'conv', 'done')\n",
+    "\n",
+    "    def __init__(self):\n",
+    "        self.rows = self.series = self.cells = 0\n",
+    "\n",
+    "    def reserve(self, n_rows, n_series, n_cells):\n",
+    "        if n_rows > self.rows:\n",
+    "            self.rows = n_rows\n",
+    "            for name in self.ROW_FLOAT:\n",
+    "                setattr(self, name, np.empty(n_rows))\n",
+    "            for name in self.ROW_INT:\n",
+    "                setattr(self, name, np.empty(n_rows, dtype=np.intp))\n",
+    "        if n_cells > self.cells:\n",
+    "            self.cells = n_cells\n",
+    "            self.grid = np.empty(n_cells)\n",
+    "        if n_series > self.series:\n",
+    "            self.series = n_series\n",
+    "            for name in self.SERIES_FLOAT:\n",
+    "                setattr(self, name, np.empty(n_series))\n",
+    "            for name in self.SERIES_INT:\n",
+    "                setattr(self, name, np.empty(n_series, dtype=np.intp))\n",
+    "            for name in self.SERIES_BOOL:\n",
+    "                setattr(self, name, np.empty(n_series, dtype=bool))\n",
+    "        return self\n",
+    "\n",
+    "_SCRATCH = threading.local()\n",
+    "\n",
+    "def _views(sc, n, k, width):\n",
+    "    \"\"\"Length-n row views, length-k series views and the k x width median grid of a scratch arena.\"\"\"\n",
+    "    v = {name: getattr(sc, name)[:n] for name in FitScratch.ROW_FLOAT + FitScratch.ROW_INT}\n",
+    "    v.update({name: getattr(sc, name)[:k] for name in FitScratch.SERIES_FLOAT + FitScratch.SERIES_INT + FitScratch.SERIES_BOOL})\n",
+    "    v['grid'] = sc.grid[:k * width].reshape(k, width)\n",
+    "    return v\n",
+    "\n",
+    "def _weighted_line(a, starts, w):\n",
+    "    \"\"\"Weighted closed-form line of every series into a['m'], a['b'].\"\"\"\n",
+    "    x, y, t = a['x'], a['y'], a['t']\n",
+    "    np.add.reduceat(w, starts, out=a['Sw'])\n",
+    "    np.multiply(w, x, out=t)\n",
+    "    np.add.reduceat(t, starts, out=a['Swx'])\n",
+    "    np.multiply(t, x, out=t)\n",
+    "    np.add.reduceat(t, starts, out=a['Swxx'])\n",
+    "    np.multiply(w, y, out=t)\n",
+    "    np.add.reduceat(t, starts, out=a['Swy'])\n",
+    "    np.multiply(t, x, out=t)\n",
+    "    np.add.reduceat(t, starts, out=a['Swxy'])\n",
+    "    d, q, m, b = a['d'], a['q'], a['m'], a['b']\n",
+    "    np.multiply(a['Sw'], a['Swxx'], out=d)\n",
+    "    np.multiply(a['Swx'], a['Swx'], out=q)\n",
+    "    d -= q\n",
+    "    np.multiply(a['Sw'], a['Swxy'], out=m)\n",
+    "    np.multiply(a['Swx'], a['Swy'], out=q)\n",
+    "    m -= q\n",
+    "    m /= d\n",
+    "    np.multiply(a['Swy'], a['Swxx'], out=b)\n",
+    "    np.multiply(a['Swxy'], a['Swx'], out=q)\n",
+    "    b -= q\n",
+    "    b /= d\n",
+    "\n",
+    "def _residuals(a, m, b):\n",
+    "    \"\"\"a['r'] = y - (m x + b) with per-series m and b.\"\"\"\n",
+    "    r, t, seg = a['r'], a['t'], a['seg']\n",
+    "    np.take(m, seg, out=r, mode='clip')\n",
+    "    r *= a['x']\n",
+    "    np.take(b, seg, out=t, mode='clip')\n",
+    "    r += t\n",
+    "    np.subtract(a['y'], r, out=r)\n",
+    "\n",
+    "def _robust_scale(a):\n",
+    "    \"\"\"a['s'] = 1.4826 * per-series median of |r| sqrt(w0), from an in-place row sort of the grid.\"\"\"\n",
+    "    u, grid, s, q = a['u'], a['grid'], a['s'], a['q']\n",
+    "    np.abs(a['r'], out=u)\n",
+    "    u *= a['sw0']\n",
+    "    grid.fill(np.inf)\n",
+    "    np.put(grid, a['cell'], u, mode='clip')\n",
+    "    grid.sort(axis=1)\n",
+    "    np.take(grid, a['lo'], out=s, mode='clip')\n",
+    "    np.take(grid, a['hi'], out=q, mode='clip')\n",
+    "    s += q\n",
+    "    s *= 0.5 * MAD_SCALE\n",
+    "    np.maximum(s, np.finfo(float).tiny, out=s)\n",
+    "\n",
+    "def _irls_weights(a, psi):\n",
+    "    \"\"\"a['w'] = prior weight times the Huber or Tukey weight of each standardised residual.\"\"\"\n",
+    "    u, w, t = a['u'], a['w'], a['t']\n",
+    "    _residuals(a, a['m'], a['b'])\n",
+    "    _robust_scale(a)\n",
+    "    np.abs(a['r'], out=u)\n",
+    "    u *= a['sw0']\n",
+    "    np.take(a['s'], a['seg'], out=t, mode='clip')\n",
+    "    u /= t\n",
+    "    if psi == 'huber':\n",
+    "        np.maximum(u, HUBER_C, out=t)\n",
+    "        np.divide(HUBER_C, t, out=w)\n",
+    "    else:\n",
+    "        np.divide(u, TUKEY_C, out=t)\n",
+    "        np.multiply(t, t, out=t)\n",
+    "        np.subtract(1, t, out=t)\n",
+    "        np.maximum(t, 0, out=t)\n",
+    "        np.multiply(t, t, out=w)\n",
+    "    w *= a['w0']\n",
+    "\n",
+    "def _irls_step(a, starts, psi, tol):\n",
+    "    \"\"\"One reweighted fit of the working set. Series already marked done keep their m and b,\n",
+    "    so every result depends only on the data of its own series.\"\"\"\n",
+    "    m, b, pm, pb, q, r1, conv, done = (a[name] for name in ('m', 'b', 'pm', 'pb', 'q', 'r1', 'conv', 'done'))\n",
+    "    np.copyto(pm, m)\n",
+    "    np.copyto(pb, b)\n",
+    "    _irls_weights(a, psi)\n",
+    "    _weighted_line(a, starts, a['w'])\n",
+    "    np.copyto(m, pm, where=done)\n",
+    "    np.copyto(b, pb, where=done)\n",
+    "    # Per-series stop test on the relative change of m and b\n",
+    "    np.subtract(m, pm, out=q)\n",
+    "    np.abs(q, out=q)\n",
+    "    np.abs(m, out=r1)\n",
+    "    r1 *= tol\n",
+    "    np.less_equal(q, r1, out=conv)\n",
+    "    np.subtract(b, pb, out=q)\n",
+    "    np.abs(q, out=q)\n",
+    "    np.abs(b, out=r1)\n",
+    "    r1 *= tol\n",
+    "    np.less_equal(q, r1, out=a['better'])\n",
+    "    conv &= a['better']\n",
+    "    done |= conv\n",
+    "\n",
+    "def _irls(sc, chunk_args, psi, max_iter, tol, m_out, b_out, w_out):\n",
+    "    \"\"\"Iteratively reweighted fit with weight function psi, starting from and updating m_out, b_out.\n",
+    "\n",
+    "    A series has converged once m and b change by at most tol relative. Converged series are\n",
+    "    dropped from the working set whenever half of it has finished, as in rate_law_lm_batch.\"\"\"\n",
+    "    offsets = chunk_args[2]\n",
+    "    work = np.arange(len(offsets) - 1)\n",
+    "    rows, sub = None, offsets\n",
+    "    it = 0\n",
+    "    while work.size and it < max_iter:\n",
+    "        a = _views(sc, sub[-1], work.size, np.diff(sub).max())\n",
+    "        _load(a, *chunk_args, rows=rows, sub=sub)\n",
+    "        np.take(m_out, work, out=a['m'], mode='clip')\n",
+    "        np.take(b_out, work, out=a['b'], mode='clip')\n",
+    "        starts = sub[:-1]\n",
+    "        done = a['done']\n",
+    "        done.fill(False)\n",
+    "        while it < max_iter and work.size - np.count_nonzero(done) > work.size // 2:\n",
+    "            it += 1\n",
+    "            _irls_step(a, starts, psi, tol)\n",
+    "        # Weights at the final m and b, whenever the series left the working set\n",
+    "        _irls_weights(a, psi)\n",
+    "        m_out[work] = a['m']\n",
+    "        b_out[work] = a['b']\n",
+    "        if rows is None:\n",
+    "            np.copyto(w_out, a['w'])\n",
+    "        else:\n",
+    "            w_out[rows] = a['w']\n",
+    "        work = work[~done]\n",
+    "        rows, sub = series_rows(offsets, work)\n",
+    "\n",
+    "def _ransac_trial(a, starts, rng, tau):\n",
+    "    \"\"\"Score one random two-point line per series and keep it where it has the most inliers.\"\"\"\n",
+    "    x, y, r, mask = a['x'], a['y'], a['r'], a['mask']\n",
+    "    i, j, r1, r2 = a['i'], a['j'], a['r1'], a['r2']\n",
+    "    m, b, count = a['m'], a['b'], a['count']\n",
+    "    # Two distinct rows of every series\n",
+    "    rng.random(out=r1)\n",
+    "    r1 *= a['nf']\n",
+    "    np.floor(r1, out=r1)\n",
+    "    rng.random(out=r2)\n",
+    "    np.subtract(a['nf'], 1, out=a['q'])\n",
+    "    r2 *= a['q']\n",
+    "    np.floor(r2, out=r2)\n",
+    "    r2 += r1\n",
+    "    r2 += 1\n",
+    "    np.fmod(r2, a['nf'], out=r2)\n",
+    "    np.copyto(i, r1, casting='unsafe')\n",
+    "    np.copyto(j, r2, casting='unsafe')\n",
+    "    i += starts\n",
+    "    j += starts\n",
+    "    np.take(y, j, out=m, mode='clip')\n",
+    "    np.take(y, i, out=a['q'], mode='clip')\n",
+    "    m -= a['q']\n",
+    "    np.take(x, j, out=b, mode='clip')\n",
+    "    np.take(x, i, out=a['q'], mode='clip')\n",
+    "    b -= a['q']\n",
+    "    m /= b\n",
+    "    np.take(x, i, out=b, mode='clip')\n",
+    "    b *= m\n",
+    "    np.take(y, i, out=a['q'], mode='clip')\n",
+    "    np.subtract(a['q'], b, out=b)\n",
+    "\n",
+    "    _residuals(a, m, b)\n",
+    "    np.abs(r, out=r)\n",
+    "    r /= y\n",
+    "    np.less_equal(r, tau, out=mask)\n",
+    "    np.add.reduceat(mask, starts, out=count)\n",
+    "    np.greater(count, a['best_n'], out=a['better'])\n",
+    "    np.copyto(a['best_m'], m, where=a['better'])\n",
+    "    np.copyto(a['best_b'], b, where=a['better'])\n",
+    "    np.copyto(a['best_n'], count, where=a['better'])\n",
+    "\n",
+    "def _ransac(a, starts, rng, n_trials, tau):\n",
+    "    \"\"\"Best two-point line per series by inlier count, then a weighted refit of its inliers.\"\"\"\n",
+    "    y, r, mask = a['y'], a['r'], a['mask']\n",
+    "    a['best_n'].fill(-1)\n",
+    "    for _ in range(n_trials):\n",
+    "        _ransac_trial(a, starts, rng, tau)\n",
+    "    _residuals(a, a['best_m'], a['best_b'])\n",
+    "    np.abs(r, out=r)\n",
+    "    r /= y\n",
+    "    np.less_equal(r, tau, out=mask)\n",
+    "    np.multiply(a['w0'], mask, out=a['w'])\n",
+    "    _weighted_line(a, starts, a['w'])\n",
+    "\n",
+    "def _load(a, S, v, offsets, sigma, error_model, rows=None, sub=None):\n",
+    "    \"\"\"Fill the buffers of a with a chunk, or with its rows `rows` (series bounds `sub`).\n",
+    "\n",
+    "    Prior weights are scaled to a maximum of 1 within each series, so nothing depends on\n",
+    "    which other series share the chunk.\"\"\"\n",
+    "    if rows is None:\n",
+    "        sub = offsets\n",
+    "        np.copyto(a['t'], S)\n",
+    "        np.copyto(a['u'], v)\n",
+    "        if sigma is not None:\n",
+    "            np.copyto(a['r'], sigma)\n",
+    "    else:\n",
+    "        np.take(S, rows, out=a['t'], mode='clip')\n",
+    "        np.take(v, rows, out=a['u'], mode='clip')\n",
+    "        if sigma is not None:\n",
+    "            np.take(sigma, rows, out=a['r'], mode='clip')\n",
+    "    v = a['u']\n",
+    "    np.divide(1, a['t'], out=a['x'])\n",
+    "    np.divide(1, v, out=a['y'])\n",
+    "    w0 = a['w0']\n",
+    "    if sigma is not None:\n",
+    "        np.multiply(v, v, out=w0)\n",
+    "        np.multiply(w0, w0, out=w0)\n",
+    "        w0 /= a['r']\n",
+    "        w0 /= a['r']\n",
+    "    elif error_model == 'relative':\n",
+    "        np.multiply(v, v, out=w0)\n",
+    "    elif error_model == 'absolute':\n",
+    "        np.multiply(v, v, out=w0)\n",
+    "        np.multiply(w0, w0, out=w0)\n",
+    "    else:\n",
+    "        w0.fill(1.0)\n",
+    "    k = len(sub) - 1\n",
+    "    starts = sub[:-1]\n",
+    "    n_per = np.diff(sub)\n",
+    "    width = n_per.max()\n",
+    "    a['seg'][:] = np.repeat(np.arange(k), n_per)\n",
+    "    np.maximum.reduceat(w0, starts, out=a['q'])\n",
+    "    np.take(a['q'], a['seg'], out=a['t'], mode='clip')\n",
+    "    w0 /= a['t']\n",
+    "    np.sqrt(w0, out=a['sw0'])\n",
+    "    # Row i of series j goes to cell (j, i - start_j) of the grid, padded with +inf\n",
+    "    a['cell'][:] = np.arange(sub[-1]) + np.repeat(np.arange(k) * width - starts, n_per)\n",
+    "    np.copyto(a['nf'], n_per)\n",
+    "    np.add(np.arange(k) * width, (n_per - 1) // 2, out=a['lo'])\n",
+    "    np.add(np.arange(k) * width, n_per // 2, out=a['hi'])\n",
+    "\n",
+    "def _robust_chunk(chunk_args, method, rng, max_iter, tol, n_trials, tau, m_out, b_out, w_out):\n",
+    "    \"\"\"Fit one chunk (S, v, offsets, sigma, error_model) in the calling thread's scratch arena.\"\"\"\n",
+    "    offsets = chunk_args[2]\n",
+    "    n, k, width = offsets[-1], len(offsets) - 1, np.diff(offsets).max()\n",
+    "    if not hasattr(_SCRATCH, 'arena'):\n",
+    "        _SCRATCH.arena = FitScratch()\n",
+    "    sc = _SCRATCH.arena.reserve(n, k, k * width)\n",
+    "    a = _views(sc, n, k, width)\n",
+    "    _load(a, *chunk_args)\n",
+    "    starts = offsets[:-1]\n",
+    "    np.copyto(a['w'], a['w0'])\n",
+    "    _weighted_line(a, starts, a['w0'])\n",
+    "    if method == 'ransac':\n",
+    "        _ransac(a, starts, rng, n_trials, tau)\n",
+    "    np.copyto(m_out, a['m'])\n",
+    "    np.copyto(b_out, a['b'])\n",
+    "    np.copyto(w_out, a['w'])\n",
+    "    if method in ('huber', 'tukey'):\n",
+    "        _irls(sc, chunk_args, 'huber', max_iter, tol, m_out, b_out, w_out)\n",
+    "        if method == 'tukey':\n",
+    "            _irls(sc, chunk_args, 'tukey', max_iter, tol, m_out, b_out, w_out)\n",
+    "\n",
+    "def robust_lineweaver_burk(S, v, offsets, method='huber', sigma=None, error_model='relative', E0=0.028,\n",
+    "                           max_iter=50, tol=1e-6, n_trials=32, tau=0.1, seed=0, chunk=4096, n_threads=None):\n",
+    "    \"\"\"Weighted Lineweaver-Burk fit of a batch with optional Huber/Tukey IRLS or RANSAC.\n",
+    "\n",
+    "    method is 'wls', 'huber', 'tukey' or 'ransac'; sigma (per point, standard deviation of v)\n",
+    "    overrides error_model ('relative', 'absolute' or 'none'). Returns vmax, Km, k2 per series\n",
+    "    and the final weight of every point (0 marks a rejected outlier).\"\"\"\n",
+    "    if method not in ROBUST_METHODS:\n",
+    "        raise ValueError(f\"unknown method {method!r}, expected one of {ROBUST_METHODS}\")\n",
+    "    if error_model not in ERROR_MODELS:\n",
+    "        raise ValueError(f\"unknown error_model {error_model!r}, expected one of {ERROR_MODELS}\")\n",
+    "    n_series = len(offsets) - 1\n",
+    "    m, b = np.empty(n_series), np.empty(n_series)\n",
+    "    weights = np.empty(S.size)\n",
+    "\n",
+    "    def run(j0):\n",
+    "        j1 = min(j0 + chunk, n_series)\n",
+    "        lo, hi = offsets[j0], offsets[j1]\n",
+    "        rng = np.random.Generator(np.random.Philox(np.random.SeedSequence([seed, j0 // chunk])))\n",
+    "        chunk_args = (S[lo:hi], v[lo:hi], offsets[j0:j1 + 1] - lo, None if sigma is None else sigma[lo:hi], error_model)\n",
+    "        _robust_chunk(chunk_args, method, rng, max_iter, tol, n_trials, tau, m[j0:j1], b[j0:j1], weights[lo:hi])\n",
+    "\n",
+    "    WorkStealingPool(n_threads).map(run, range(0, n_series, chunk))\n",
+    "    vmax = 1 / b\n",
+    "    return {'m': m, 'b': b, 'vmax': vmax, 'Km': m * vmax, 'k2': vmax / E0, 'weights': weights}\n",
+    "\n",
+    "# Pepsin with one corrupted low-rate well (v at 0.1 mM read 30% low)\n",
+    "v_bad = v.copy()\n",
+    "v_bad[0] *= 0.7\n",
+    "pep_off = np.array([0, len(S)])\n",
+    "print(f\"{'fit':<18} {'vmax':>8} {'Km':>8} {'k2':>8}  weight of corrupted point\")\n",
+    "for label, kwargs in [('clean, unweighted', dict(method='wls', error_model='none', v_=v)),\n",
+    "                      ('unweighted', dict(method='wls', error_model='none')),\n",
+    "                      ('weighted (1/v)', dict(method='wls')),\n",
+    "                      ('Huber', dict(method='huber')),\n",
+    "                      ('Tukey', dict(method='tukey')),\n",
+    "                      ('RANSAC', dict(method='ransac'))]:\n",
+    "    v_in = kwargs.pop('v_', v_bad)\n",
+    "    r_fit = robust_lineweaver_burk(S, v_in, pep_off, **kwargs)\n",
+    "    print(f\"{label:<18} {r_fit['vmax'][0]:8.4f} {r_fit['Km'][0]:8.4f} {r_fit['k2'][0]:8.4f}  {r_fit['weights'][0]:.3g}\")\n",
+    "try:\n",
+    "    robust_lineweaver_burk(S, v_bad, pep_off, method='Huber')\n",
+    "except ValueError as e:\n",
+    "    print(e)"
+   ]
+  },
+  {
+   "cell_type": "markdown",
+   "id": "897b2aec-a4e8-48cf-83aa-10e362344d6c",
+   "metadata": {},
+   "source": [
+    "The benchmark corrupts one random point in 10% of the series of a synthetic plate, with 2% multiplicative noise elsewhere. It reports throughput and the error in $K_M$ for each mode. On a 20,000-series subset it then measures how far the default stopping rule leaves the Huber and Tukey fits from a tightly converged one (`tol=1e-12`, 1,000 iterations), and checks that the results do not change with the chunk size. Finally `tracemalloc` records the largest allocation made during a single IRLS step or RANSAC trial on a 4,096-series chunk. It should be a few kilobytes: NumPy's fixed-size sort and casting buffers plus small Python objects, not a row-sized array."
+   ]
+  },
+  {
+   "cell_type": "code",
+   "execution_count": 108,
+   "id": "5532806b-cb31-4a03-8a23-3095aa1a9dd6",
+   "metadata": {},
+   "outputs": [
+    {
+     "name": "stdout",
+     "output_type": "stream",
+     "text": [
+      "mode           series/s  median |dKm|/Km  p99 |dKm|/Km  outlier series p50\n",
+      "plain         3,932,524            2.74%       253.06%              30.43%\n",
+      "wls           2,806,854            2.16%        41.53%              13.58%\n",
+      "huber           176,849            2.00%         8.22%               2.32%\n",
+      "tukey            93,023            2.03%         8.23%               2.17%\n",
+      "ransac          189,531            1.95%         7.80%               2.10%\n",
+      "huber: |dKm|/Km vs converged fit p99 5.4e-06, max 1.6e-02, 0.08% of series above 1e-3; chunk=64 gives identical Km: True\n",
+      "tukey: |dKm|/Km vs converged fit p99 3.1e-05, max 3.3e-02, 0.18% of series above 1e-3; chunk=64 gives identical Km: True\n",
+      "IRLS step (Huber): at most 2,792 bytes allocated per call (one row buffer is 229,376 bytes)\n",
+      "IRLS step (Tukey): at most 2,792 bytes allocated per call (one row buffer is 229,376 bytes)\n",
+      "RANSAC trial     : at most 9,472 bytes allocated per call (one row buffer is 229,376 bytes)\n"
+     ]
+    }
+   ],
+   "source": [
+    "import tracemalloc\n",
+    "\n",
+    "def synthetic_plate_with_outliers(n_series, frac=0.1, n_points=7, noise=0.02, seed=11):\n",
+    "    \"\"\"Plate with known Km where a fraction of series has one well read at 30-60% of its rate.\"\"\"\n",
+    "    rng = np.random.default_rng(seed)\n",
+    "    S_grid = np.geomspace(0.1, 20.0, n_points)\n",
+    "    vmax_j = 0.0145 * rng.uniform(0.5, 1.5, n_series)\n",
+    "    Km_j = 0.3267 * rng.uniform(0.5, 1.5, n_series)\n",
+    "    S_o = np.tile(S_grid, n_series)\n",
+    "    v_o = np.repeat(vmax_j, n_points) * S_o / (np.repeat(Km_j, n_points) + S_o)\n",
+    "    v_o *= 1 + noise * rng.standard_normal(S_o.size)\n",
+    "    bad = np.flatnonzero(rng.random(n_series) < frac)\n",
+    "    v_o[bad * n_points + rng.integers(0, n_points, bad.size)] *= rng.uniform(0.3, 0.6, bad.size)\n",
+    "    return S_o, v_o, np.arange(n_series + 1) * n_points, Km_j, bad\n",
+    "\n",
+    "n_series = 100_000\n",
+    "S_o, v_o, off_o, Km_true, bad = synthetic_plate_with_outliers(n_series)\n",
+    "is_bad = np.zeros(n_series, dtype=bool)\n",
+    "is_bad[bad] = True\n",
+    "\n",
+    "t0 = time.perf_counter()\n",
+    "plain = lineweaver_burk_batch(S_o, v_o, off_o)\n",
+    "t_plain = time.perf_counter() - t0\n",
+    "print(f\"{'mode':<12} {'series/s':>10} {'median |dKm|/Km':>16} {'p99 |dKm|/Km':>13} {'outlier series p50':>19}\")\n",
+    "rel = np.abs(plain['Km'] / Km_true - 1)\n",
+    "print(f\"{'plain':<12} {n_series / t_plain:10,.0f} {np.median(rel):16.2%} {np.percentile(rel, 99):13.2%} {np.median(rel[is_bad]):19.2%}\")\n",
+    "for method in ('wls', 'huber', 'tukey', 'ransac'):\n",
+    "    t0 = time.perf_counter()\n",
+    "    fit_o = robust_lineweaver_burk(S_o, v_o, off_o, method=method)\n",
+    "    dt = time.perf_counter() - t0\n",
+    "    rel = np.abs(fit_o['Km'] / Km_true - 1)\n",
+    "    print(f\"{method:<12} {n_series / dt:10,.0f} {np.median(rel):16.2%} {np.percentile(rel, 99):13.2%} {np.median(rel[is_bad]):19.2%}\")\n",
+    "\n",
+    "# Distance of the default stopping rule from a tightly converged fit, and chunk-size independence\n",
+    "n_sub = 20_000\n",
+    "S_t, v_t, off_t = S_o[:7 * n_sub], v_o[:7 * n_sub], off_o[:n_sub + 1]\n",
+    "for method in ('huber', 'tukey'):\n",
+    "    fit_d = robust_lineweaver_burk(S_t, v_t, off_t, method=method)\n",
+    "    fit_c = robust_lineweaver_burk(S_t, v_t, off_t, method=method, chunk=64)\n",
+    "    fit_r = robust_lineweaver_burk(S_t, v_t, off_t, method=method, tol=1e-12, max_iter=1000)\n",
+    "    dev = np.abs(fit_d['Km'] / fit_r['Km'] - 1)\n",
+    "    print(f\"{method}: |dKm|/Km vs converged fit p99 {np.percentile(dev, 99):.1e}, max {dev.max():.1e},\"\n",
+    "          f\" {np.mean(dev > 1e-3):.2%} of series above 1e-3; chunk=64 gives identical Km: {np.array_equal(fit_d['Km'], fit_c['Km'])}\")\n",
+    "\n",
+    "def step_allocations(step, n_calls=50):\n",
+    "    \"\"\"Largest traced allocation made during any single call of step().\"\"\"\n",
+    "    tracemalloc.start()\n",
+    "    worst = 0\n",
+    "    for _ in range(n_calls):\n",
+    "        tracemalloc.reset_peak()\n",
+    "        base = tracemalloc.get_traced_memory()[0]\n",
+    "        step()\n",
+    "        worst = max(worst, tracemalloc.get_traced_memory()[1] - base)\n",
+    "    tracemalloc.stop()\n",
+    "    return worst\n",
+    "\n",
+    "# One chunk loaded into an arena, as a worker thread sees it\n",
+    "k = 4096\n",
+    "a = _views(FitScratch().reserve(7 * k, k, 7 * k), 7 * k, k, 7)\n",
+    "_load(a, S_o[:7 * k], v_o[:7 * k], off_o[:k + 1], None, 'relative')\n",
+    "starts = off_o[:k]\n",
+    "_weighted_line(a, starts, a['w0'])\n",
+    "a['done'].fill(False)\n",
+    "a['best_n'].fill(-1)\n",
+    "rng = np.random.Generator(np.random.Philox(np.random.SeedSequence([0, 0])))\n",
+    "for name, step in (('IRLS step (Huber)', lambda: _irls_step(a, starts, 'huber', 0.0)),\n",
+    "                   ('IRLS step (Tukey)', lambda: _irls_step(a, starts, 'tukey', 0.0)),\n",
+    "                   ('RANSAC trial', lambda: _ransac_trial(a, starts, rng, 0.1))):\n",
+    "    print(f\"{name:<17}: at most {step_allocations(step):,} bytes allocated per call\"\n",
+    "          f\" (one row buffer is {a['x'].nbytes:,} bytes)\")"
+   ]
+  },
+  {
+   "cell_type": "markdown",
+   "id": "855108bf-ee9d-4cd7-beec-59437d8c1555",
+   "metadata": {},
+   "source": [
+    "The robust modes do not keep the throughput of the plain fit. Weighting alone costs little, but every IRLS iteration re-sorts the residual grid for the robust scale and makes a few dozen numpy calls, and RANSAC scores 32 trial lines per series. In this implementation the Huber, Tukey and RANSAC fits stay more than an order of magnitude slower than the plain closed form."
+   ]
+  },
   {
    "cell_type": "code",
    "execution_count": null,